@@ -22,11 +22,45 @@ using namespace std;
  *     are reflected over OX                                                       *
  *   - as a result we get a random sequence of bits of length 4n satisfying [P1]   *
  *                                                                                 * 
- * The implementation is based on vector of booleans                               *
- *    - an optimized version of the vector container                               *
- *      for storing binary sequences (1 bit per each bool)                         *
+ * The implementation is based on PackedBits (64 bits per word); bits are         *
+ * shuffled with the same random numbers as std::shuffle would use, so the paths  *
+ * are the same as the ones of the former implementation on vector<bool>.          *
+ *                                                                                 *
+ * In the streaming mode the path of the second algorithm is sampled bit by bit    *
+ * in bounded memory (see FlawedPath.hpp).                                         *
  ***********************************************************************************/
  
+/***********************************************************************************
+ * Walk over one byte of a PackedBits word (8 steps, the most significant bit      *
+ * first, 1 - up, 0 - down) precomputed for every byte: the net displacement, the  *
+ * lowest level reached after at least one step and the first step reaching it.    *
+ ***********************************************************************************/
+struct PrefixSteps {
+	signed char disp[256];
+	signed char min_lvl[256];
+	unsigned char min_pos[256]; // 0..7
+
+	PrefixSteps() {
+		for(int byte = 0; byte < 256; ++byte) {
+			int lvl = 0;
+			min_lvl[byte] = 8;
+			for(int j = 0; j < 8; ++j) {
+				lvl += ((byte >> (7 - j)) & 1) ? 1 : -1;
+				if(lvl < min_lvl[byte]) {
+					min_lvl[byte] = lvl;
+					min_pos[byte] = j;
+				}
+			}
+			disp[byte] = lvl;
+		}
+	}
+};
+
+static const PrefixSteps& prefixSteps() {
+	static const PrefixSteps steps;
+	return steps;
+}
+
  /***********************************************************************************
  *  PUBLIC METHODS                                                                 *
  ***********************************************************************************/ 
@@ -40,100 +74,136 @@ void FlawedPath::setSeed(int64 seed) {
 	mt_eng.seed(seed);
 }
 		
-vector<bool>* FlawedPath::generateBitSequence(int64 path_n) {
+const PackedBits* FlawedPath::generateBitSequence(int64 path_n) {
 	n = path_n;
 	initSequences();
 	// divide the control sequence into subsequences of equal bits
 	// and for each such subsequence generate a dyck path
-	vector<bool>::iterator it_begin_dyck = flawed_bitseq.begin();
-	vector<bool>::iterator it = ctrl_bitseq.begin();
-	while(it != ctrl_bitseq.end()) {
+	int64 begin_dyck = 0;
+	int64 i = 0;
+	while(i != 2*n) {
 		// find next subsequence of consecutive 0s or 1s
-		vector<bool>::iterator it_begin_sub_ctrl = it; // inclusive
-		bool b = *it_begin_sub_ctrl;
-		while(++it != ctrl_bitseq.end() && *it == b) { /* Intentionally empty */ }
+		int64 begin_sub_ctrl = i; // inclusive
+		bool b = ctrl_bitseq.get(begin_sub_ctrl);
+		while(++i != 2*n && ctrl_bitseq.get(i) == b) { /* Intentionally empty */ }
 		// get the length of this sequence
-		auto sub_ctrl_len = distance(it_begin_sub_ctrl, it);
+		int64 sub_ctrl_len = i - begin_sub_ctrl;
 		// generate next Dyck Paths
-		generateDyckPath(it_begin_dyck, it_begin_dyck + 2*sub_ctrl_len + 1, b);
-		it_begin_dyck += 2*sub_ctrl_len;
+		generateDyckPath(begin_dyck, begin_dyck + 2*sub_ctrl_len + 1, b);
+		begin_dyck += 2*sub_ctrl_len;
 	}
 	
-	flawed_bitseq.pop_back(); // discard last bit
+	flawed_bitseq.popBack(); // discard last bit
 	return &flawed_bitseq; 			
 }
 
-vector<bool>* FlawedPath::generateBitSequence2(int64 path_n) {
+const PackedBits* FlawedPath::generateBitSequence2(int64 path_n) {
 	n = path_n;
 	initSequences2();
 	// copy the control sequence into first 2n bits of generated path
-	copy(ctrl_bitseq.begin(), ctrl_bitseq.end(), flawed_bitseq.begin());
+	flawed_bitseq.copy(ctrl_bitseq, 0, 2*n, 0);
 	// find lengths of Dyck Paths that will form the 2nd part of flawed path
 	vector<int64> dyck_lenghts;
 	findSubpathLenghts(dyck_lenghts);
 	// shuffle lengths - random ordering of Dyck paths
 	//shuffle(dyck_lenghts->begin(), dyck_lenghts->end(), mt_eng);
 	// generate corresponding paths
-	vector<bool>::iterator it_begin_dyck = flawed_bitseq.begin() + 2*n;
+	int64 begin_dyck = 2*n;
 	for(auto len : dyck_lenghts) {
 		//cout << "Found subpath of length " << len << endl;
 		bool above = len > 0;
 		int64 len_pos = above ? len : -len;
-		generateDyckPath(it_begin_dyck, it_begin_dyck + len_pos + 1, !above);
-		it_begin_dyck += len_pos;
+		generateDyckPath(begin_dyck, begin_dyck + len_pos + 1, !above);
+		begin_dyck += len_pos;
 	} 
 	
-	flawed_bitseq.pop_back(); // discard last bit
+	flawed_bitseq.popBack(); // discard last bit
 	return &flawed_bitseq; 			
 }
 		
-vector<bool>* FlawedPath::generateBitSequence(int64 path_n, int64 seed) {
+const PackedBits* FlawedPath::generateBitSequence(int64 path_n, int64 seed) {
 	setSeed(seed);
 	return generateBitSequence(path_n);
 }
 
-vector<bool>* FlawedPath::generateBitSequence2(int64 path_n, int64 seed) {
+const PackedBits* FlawedPath::generateBitSequence2(int64 path_n, int64 seed) {
 	setSeed(seed);
 	return generateBitSequence2(path_n);
 }
 
-vector<bool>::iterator FlawedPath::itPathBegin() {
-	return flawed_bitseq.begin();
+int64 FlawedPath::pathLength() const {
+	return flawed_bitseq.size();
 }
 
-vector<bool>::iterator FlawedPath::itPathEnd() {
-	return flawed_bitseq.end();
+// 64 bits of the path starting at pos, bit pos is the most significant one
+uint64 FlawedPath::getPathWord(int64 pos) const {
+	return flawed_bitseq.getWord(pos);
+}
+
+// starts a new path of length 4n (as generateBitSequence2) read with nextStreamWord
+void FlawedPath::startStream(int64 path_n) {
+	stream_n = path_n;
+	stream_pos = 0;
+	ctrl_ones_left = 0;
+	ctrl_lvl = 0;
+	sub_len = 0;
+	sub_end = 0;
+	sub_lengths.clear();
+	sub_ind = 0;
+	dyck_left = 0;
+	dyck_below = false;
+}
+
+void FlawedPath::startStream(int64 path_n, int64 seed) {
+	setSeed(seed);
+	startStream(path_n);
+}
+
+bool FlawedPath::streamEnded() const {
+	return stream_pos + 64 > 4*stream_n;
+}
+
+// next 64 bits of the path, the first bit is the most significant one
+uint64 FlawedPath::nextStreamWord() {
+	uint64 r = 0;
+	for(int j = 0; j < 64; ++j) {
+		bool bit = stream_pos < 2*stream_n ? nextCtrlBit() : nextDyckBit();
+		r = (r << 1) | bit;
+		++stream_pos;
+	}
+	return r;
 }
 
 
 void FlawedPath::printBitsAscii() {
-	for(auto b : flawed_bitseq) {
-		cout << b;
+	for(int64 i = 0; i < flawed_bitseq.size(); ++i) {
+		cout << flawed_bitseq.get(i);
 	}
 }
 
 void FlawedPath::prettyPrintPath() {
 	cout << string(80, '-') << endl;
 // 	cout << "Control path of length " << 2*n << endl;
-// 	for(auto b : ctrl_bitseq) {
-// 		cout << b;
+// 	for(int64 i = 0; i < ctrl_bitseq.size(); ++i) {
+// 		cout << ctrl_bitseq.get(i);
 // 	}
 	cout << endl << string(40, '-') << endl;
 	cout << "Path of length " << 4*n << endl;
-	for(auto it = flawed_bitseq.begin(); it != flawed_bitseq.end(); ++it) {
-		cout << *it;
-		if(it + 1 !=  flawed_bitseq.end()) { 
+	for(int64 i = 0; i < flawed_bitseq.size(); ++i) {
+		cout << flawed_bitseq.get(i);
+		if(i + 1 != flawed_bitseq.size()) { 
 			cout << ",";
 		}
 	}
-	for(auto b : flawed_bitseq) {
-		cout << b << ",";
+	for(int64 i = 0; i < flawed_bitseq.size(); ++i) {
+		cout << flawed_bitseq.get(i) << ",";
 	}
 	cout << endl;
 	cout << endl << string(40, '-') << endl;
-	int64 min_lvl = - firstLowestLevel(flawed_bitseq.begin(), flawed_bitseq.end()).second;
+	int64 min_lvl = - firstLowestLevel(flawed_bitseq, 0, flawed_bitseq.size()).second;
 	int64 lvl = 0;
-	for(auto b : flawed_bitseq) {
+	for(int64 i = 0; i < flawed_bitseq.size(); ++i) {
+		bool b = flawed_bitseq.get(i);
 		cout << b << ' ';
 		if(b) {
 			if(lvl < 0) {
@@ -176,108 +246,168 @@ void FlawedPath::initSequences2() {
 
 void FlawedPath::initCtrlSeq() {
 	ctrl_bitseq.assign(2*n, false); // resize container for control sequence if necessary
-	fill(ctrl_bitseq.begin(), ctrl_bitseq.begin() + n, true);
-	shuffleBitseq(ctrl_bitseq.begin(), ctrl_bitseq.end());
+	ctrl_bitseq.fill(0, n, true);
+	shuffleBitseq(ctrl_bitseq, 0, 2*n);
 }
 
 void FlawedPath::initCtrlSeq2() {
 	ctrl_bitseq.assign(2*n, false); // resize container for control sequence if necessary
-	//cout << ctrl_bitseq.size();
 	// first n bits b_0..b_{n-1} - random
-	vector<bool>::iterator it = ctrl_bitseq.begin();
-	vector<bool>::iterator end = ctrl_bitseq.begin() + n;
+	// (64 bits of the first number, then 65 bits of each next one - the last one
+	// being the sign bit repeated by the arithmetic shift)
 	int i = 0;
 	int64 r = mt_eng();
     
-	while(it != end) {
+	for(int64 pos = 0; pos < n; ++pos) {
 		if(i++ >= 64) {
 			r = mt_eng();
 			i = 0;
 		}
-		*(it++) = ((r & 1) != 0);
+		if(r & 1) {
+			ctrl_bitseq.flip(pos);
+		}
 		r >>= 1;
 	}
 	// next n bits b_n..b_{2n-1} - random permutation of complements of b_0...b-{n-1}
-	vector<bool>::iterator begin = ctrl_bitseq.begin();
-	end = ctrl_bitseq.end();
-	while(it != end) { // complement
-		*(it++) = !(*(begin++));
-	} // begin -> b_n, end -> b_2n
-	shuffleBitseq(begin, end);
+	ctrl_bitseq.copy(ctrl_bitseq, 0, n, n);
+	ctrl_bitseq.complement(n, 2*n);
+	shuffleBitseq(ctrl_bitseq, n, 2*n);
 }
 
 
-		
-void FlawedPath::shuffleBitseq(vector<bool>::iterator begin, vector<bool>::iterator end) {
-	shuffle(begin, end, mt_eng);
+static void swapBits(PackedBits& seq, int64 i, int64 j) {
+	if(seq.get(i) != seq.get(j)) {
+		seq.flip(i);
+		seq.flip(j);
+	}
+}
+
+// Fisher-Yates shuffle of bits [begin, end), step by step the same as std::shuffle
+// of libstdc++ (two positions from one random number while the range is small enough)
+void FlawedPath::shuffleBitseq(PackedBits& seq, int64 begin, int64 end) {
+	typedef uniform_int_distribution<uint64> distr_type;
+	const uint64 range = end - begin;
+	if(range == 0) {
+		return;
+	}
+	const uint64 rng_range = mt_eng.max() - mt_eng.min();
+	int64 i = begin + 1;
+	if(rng_range / range >= range) {
+		if(range % 2 == 0) {
+			distr_type d(0, 1);
+			swapBits(seq, i++, begin + d(mt_eng));
+		}
+		while(i != end) {
+			const uint64 swap_range = i - begin + 1;
+			const uint64 x = distr_type(0, swap_range * (swap_range + 1) - 1)(mt_eng);
+			swapBits(seq, i++, begin + x / (swap_range + 1));
+			swapBits(seq, i++, begin + x % (swap_range + 1));
+		}
+		return;
+	}
+	for(; i != end; ++i) {
+		swapBits(seq, i, begin + distr_type(0, i - begin)(mt_eng));
+	}
 }
 
-void FlawedPath::generateDyckPath(vector<bool>::iterator begin, vector<bool>::iterator end, bool b) {
-	auto len = distance(begin, end); // 2k + 1
+void FlawedPath::generateDyckPath(int64 begin, int64 end, bool b) {
+	int64 len = end - begin; // 2k + 1
 	// init bits - k 1s and k+1 0s
-	fill(begin, begin + len/2, true);
-	// fill(begin, begin + (b ? len/2 : (len+1)/2), true);
+	flawed_bitseq.fill(begin, begin + len/2, true);
 	// permute the (sub)vector of k 1s and k+1 0s
-	shuffleBitseq(begin, end);
+	shuffleBitseq(flawed_bitseq, begin, end);
 	// split into P1 and P2 at the path's minimum and swap P1 with P2
-	swapSubpaths(begin, end, firstLowestLevelIterator(begin, end));
-	// swapSubpaths(begin, end, b ? firstLowestLevelIterator(begin, end) : firstHighestLevel(begin, end));
+	swapSubpaths(begin, end, firstLowestLevelIndex(flawed_bitseq, begin, end));
 	// if path corresponds to 0s in control sequence, reflect the path over OX
 	if(!b) {
-		for(vector<bool>::iterator it = begin; it != end; ++it) {
-			*it = !(*it);
-		} // or transform(begin, end, begin, myflip, [](const bool& b) {return !b;});
+		flawed_bitseq.complement(begin, end);
 	}
 	// discard last bit - no action required
 }
 	
-// returns the iterator pointing to the bit s.t. after reading it the path reaches its lowest level for the first time
-// -1 means that the path is empty; otherwise the minimum is reached after reading a least 1 bit
+// returns the index of the bit s.t. after reading it the path reaches its lowest level for the first time
+// begin - 1 means that the path is empty; otherwise the minimum is reached after reading a least 1 bit
 // the path is starting at level 0 and ends at level -1
 // P1 is then b_{0}...b_{idx} and is empty iff the subpath is empty, P2 is b_{idx+1}...b_{2*n} and may be empty
-vector<bool>::iterator FlawedPath::firstLowestLevelIterator(vector<bool>::iterator begin,
-																vector<bool>::iterator end) {
-	return firstLowestLevel(begin,end).first;
+int64 FlawedPath::firstLowestLevelIndex(const PackedBits& seq, int64 begin, int64 end) {
+	return firstLowestLevel(seq, begin, end).first;
 }
 
-pair<vector<bool>::iterator, int64> FlawedPath::firstLowestLevel(vector<bool>::iterator begin, 
-																	vector<bool>::iterator end) {
-	auto len = distance(begin, end);
-	if(len <= 0) { 
-		return make_pair(begin - 1, 0);; // begin - 1 returned iff the subpath is empty
+pair<int64, int64> FlawedPath::firstLowestLevel(const PackedBits& seq, int64 begin, int64 end) {
+	if(end - begin <= 0) { 
+		return make_pair(begin - 1, 0); // begin - 1 returned iff the subpath is empty
 	}
-	vector<bool>::iterator it_min = begin; 
+	const PrefixSteps& prefix_steps = prefixSteps();
+	int64 idx_min = begin; 
 	int64 lvl = 0;
 	int64 min_lvl = 0;
-	for(vector<bool>::iterator it = begin; it != end; ++it) {
-		if(*it) {  
-			++lvl;
+	int64 i = begin;
+	// whole words a byte at a time (min_lvl <= lvl, so the first step strictly
+	// below min_lvl is the first one reaching the lowest level of the byte)
+	for(; i + 64 <= end; i += 64) {
+		uint64 w = seq.getWord(i);
+		if(lvl - 64 >= min_lvl) { // no new minimum within the word
+			lvl += 2 * __builtin_popcountll(w) - 64;
+			continue;
 		}
-		else {
-			--lvl;
-			if(lvl < min_lvl) {
-				min_lvl = lvl;
-				it_min = it; 						
+		for(int k = 0; k < 64; k += 8) {
+			int byte = (w >> (56 - k)) & 0xFF;
+			if(lvl + prefix_steps.min_lvl[byte] < min_lvl) {
+				min_lvl = lvl + prefix_steps.min_lvl[byte];
+				idx_min = i + k + prefix_steps.min_pos[byte];
+			}
+			lvl += prefix_steps.disp[byte];
+		}
+	}
+	// the rest bit by bit
+	if(i < end) {
+		uint64 w = seq.getWord(i);
+		int count = end - i;
+		for(int k = 0; k < count; ++k, w <<= 1) {
+			if(w >> 63) {  
+				++lvl;
+			}
+			else {
+				--lvl;
+				if(lvl < min_lvl) {
+					min_lvl = lvl;
+					idx_min = i + k; 						
+				}
 			}
 		}
 	}
-	return make_pair(it_min, min_lvl);
+	return make_pair(idx_min, min_lvl);
 }
 
+// the bit after the end of the control sequence is read as 0
+// words (bytes) far from the level 0 - the walk cannot reach it within them - are skipped
 void FlawedPath::findSubpathLenghts(vector<int64>& dyck_lenghts) {
+	const PrefixSteps& prefix_steps = prefixSteps();
 	int64 lvl = 0;
 	int64 len = 0;
-	for(auto it = ctrl_bitseq.begin(); it != ctrl_bitseq.end(); ++it) {
+	for(int64 i = 0; i < ctrl_bitseq.size(); ++i) {
+		if((i & 63) == 0 && (lvl > 64 || lvl < -64) && i + 64 <= ctrl_bitseq.size()) {
+			lvl += 2 * __builtin_popcountll(ctrl_bitseq.getWord(i)) - 64;
+			len += 64;
+			i += 63;
+			continue;
+		}
+		if((i & 7) == 0 && (lvl > 8 || lvl < -8) && i + 8 <= ctrl_bitseq.size()) {
+			lvl += prefix_steps.disp[ctrl_bitseq.getWord(i) >> 56];
+			len += 8;
+			i += 7;
+			continue;
+		}
 		++len;
 		bool above = lvl > 0;
 		bool below = lvl < 0;
-		(*it ? ++lvl : --lvl);
+		(ctrl_bitseq.get(i) ? ++lvl : --lvl);
 		if(lvl == 0) {
-			if(above && !(*(it+1))) { // path moves from +1 -> 0 -> -1
+			if(above && !ctrl_bitseq.get(i + 1)) { // path moves from +1 -> 0 -> -1
 				dyck_lenghts.push_back(len);
 				len = 0;
 			}
-			else if(below && *(it+1)) { // path moves from -1 -> 0 -> +1
+			else if(below && ctrl_bitseq.get(i + 1)) { // path moves from -1 -> 0 -> +1
 				dyck_lenghts.push_back(-len);
 				len = 0;
 			}
@@ -290,9 +420,140 @@ void FlawedPath::findSubpathLenghts(vector<int64>& dyck_lenghts) {
  * at which the first minimum is reached, constructing the path P2|P1 and discarding
  * the last bit.
  *
- * Implementation based on built-in function rotate 
+ * The rotation is done by copying P2|P1 into rotate_buf and back, a word at a time
  */
-void FlawedPath::swapSubpaths(vector<bool>::iterator begin, vector<bool>::iterator end,
-								vector<bool>::iterator idx) { // P1 -> b_0...b_idx; P2 -> b_{idx+1}...b_2n
-		rotate(begin, idx + 1, end);		
+void FlawedPath::swapSubpaths(int64 begin, int64 end, int64 idx) { // P1 -> b_0...b_idx; P2 -> b_{idx+1}...b_2n
+	int64 mid = idx + 1;
+	if(mid == begin || mid == end) {
+		return;
+	}
+	rotate_buf.assign(end - begin, false);
+	rotate_buf.copy(flawed_bitseq, mid, end, 0);
+	rotate_buf.copy(flawed_bitseq, begin, mid, end - mid);
+	flawed_bitseq.copy(rotate_buf, 0, end - begin, begin);
+}
+
+// bit stream_pos of the control sequence; lengths of subpaths are found on the way
+// as in findSubpathLenghts, one bit later (the subpath ends if the walk crosses 0)
+bool FlawedPath::nextCtrlBit() {
+	bool bit;
+	if(stream_pos < stream_n) {
+		if((stream_pos & 63) == 0) {
+			rnd_bits = mt_eng();
+		}
+		bit = rnd_bits & 1;
+		rnd_bits >>= 1;
+		ctrl_ones_left += !bit;
+	}
+	else {
+		uint64 left = 2*stream_n - stream_pos;
+		bit = (uint64) (((unsigned __int128) mt_eng() * left) >> 64) < (uint64) ctrl_ones_left;
+		ctrl_ones_left -= bit;
+	}
+	if((sub_end > 0 && !bit) || (sub_end < 0 && bit)) {
+		sub_lengths.push_back(sub_end * sub_len);
+		sub_len = 0;
+	}
+	sub_end = 0;
+	int above = ctrl_lvl > 0 ? 1 : (ctrl_lvl < 0 ? -1 : 0);
+	ctrl_lvl += bit ? 1 : -1;
+	++sub_len;
+	if(ctrl_lvl == 0) {
+		sub_end = above;
+	}
+	if(stream_pos == 2*stream_n - 1) { // the walk ends at 0 - the last subpath
+		sub_lengths.push_back(sub_end * sub_len);
+	}
+	return bit;
+}
+
+// next step of the Dyck Path of the current subpath (reflected for subpaths above 0)
+bool FlawedPath::nextDyckBit() {
+	if(dyck_left == 0 && sub_ind + 1 == sub_lengths.size() && sub_lengths[sub_ind] < 0) {
+		// findSubpathLenghts finds a subpath by the step after it, so the last subpath below 0
+		// gets no Dyck Path: its part of the path is the lowest step of the previous Dyck Path
+		// (as generateDyckPath leaves it after the path) followed by 0s
+		bool bit = dyck_below;
+		dyck_below = false;
+		return bit;
+	}
+	if(dyck_left == 0) {
+		int64 len = sub_lengths[sub_ind++];
+		dyck_below = len > 0;
+		dyck_left = len > 0 ? len : -len;
+		dyck_lvl = 0;
+	}
+	double r = dyck_left;
+	double h = dyck_lvl;
+	double p_up = (r - h) * (h + 2) / (2 * r * (h + 1));
+	bool up = (mt_eng() >> 11) * 0x1.0p-53 < p_up;
+	dyck_lvl += up ? 1 : -1;
+	--dyck_left;
+	return up != dyck_below;
+}
+
+/***********************************************************************************
+ *  PackedBits                                                                     *
+ ***********************************************************************************/
+void PackedBits::assign(int64 size, bool b) {
+	len = size;
+	words.assign(size / 64 + 2, 0);
+	if(b) {
+		fill(0, size, true);
+	}
+}
+
+int64 PackedBits::size() const {
+	return len;
+}
+
+bool PackedBits::get(int64 i) const {
+	return (words[i >> 6] >> (63 - (i & 63))) & 1;
+}
+
+void PackedBits::flip(int64 i) {
+	words[i >> 6] ^= 1ULL << (63 - (i & 63));
+}
+
+// bits i..i+63, bit i as the most significant one (a single load if i % 64 == 0)
+uint64 PackedBits::getWord(int64 i) const {
+	int s = i & 63;
+	uint64 w = words[i >> 6];
+	return s ? (w << s) | (words[(i >> 6) + 1] >> (64 - s)) : w;
+}
+
+// sets bits i..i+count-1 to the count most significant bits of w
+void PackedBits::setWord(int64 i, uint64 w, int count) {
+	uint64 mask = count == 64 ? ~0ULL : ~(~0ULL >> count);
+	w &= mask;
+	int s = i & 63;
+	uint64& w0 = words[i >> 6];
+	w0 = (w0 & ~(mask >> s)) | (w >> s);
+	if(s + count > 64) {
+		uint64& w1 = words[(i >> 6) + 1];
+		w1 = (w1 & ~(mask << (64 - s))) | (w << (64 - s));
+	}
+}
+
+void PackedBits::fill(int64 begin, int64 end, bool b) {
+	for(int64 i = begin; i < end; i += 64) {
+		setWord(i, b ? ~0ULL : 0, min<int64>(64, end - i));
+	}
+}
+
+void PackedBits::complement(int64 begin, int64 end) {
+	for(int64 i = begin; i < end; i += 64) {
+		setWord(i, ~getWord(i), min<int64>(64, end - i));
+	}
+}
+
+// bits [srcBegin, srcEnd) of src to [dst, ...); if src is this, the ranges cannot overlap
+void PackedBits::copy(const PackedBits& src, int64 srcBegin, int64 srcEnd, int64 dst) {
+	for(int64 i = 0; i < srcEnd - srcBegin; i += 64) {
+		setWord(dst + i, src.getWord(srcBegin + i), min<int64>(64, srcEnd - srcBegin - i));
+	}
+}
+
+void PackedBits::popBack() {
+	--len;
 }
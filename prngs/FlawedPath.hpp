@@ -4,10 +4,46 @@
 #include <cstdlib>
 #include <bitset>
 #include <random>
+#include <vector>
 
 typedef long long int64;
+typedef unsigned long long uint64;
 
-/*********************************************************************************** 
+/***********************************************************************************
+ * Sequence of bits packed into 64-bit words. Bit i is stored in the word i / 64,  *
+ * starting from the most significant bit, so 64 consecutive bits starting at     *
+ * a multiple of 64 form a number read with a single load (the first bit being     *
+ * the most significant one). Ranges of bits are filled, complemented and copied   *
+ * a word at a time.                                                               *
+ ***********************************************************************************/
+class PackedBits {
+	public:
+		void assign(int64 size, bool b);
+
+		int64 size() const;
+
+		bool get(int64 i) const;
+
+		void flip(int64 i);
+
+		uint64 getWord(int64 i) const;
+
+		void setWord(int64 i, uint64 w, int count);
+
+		void fill(int64 begin, int64 end, bool b);
+
+		void complement(int64 begin, int64 end);
+
+		void copy(const PackedBits& src, int64 srcBegin, int64 srcEnd, int64 dst);
+
+		void popBack();
+
+	private:
+		int64 len = 0;
+		std::vector<uint64> words; // two more words than needed - getWord may read past the end
+};
+
+/***********************************************************************************
  * Generator of "flawed" bitsequences based on Dyck Path.                          *
  *                                                                                 *
  * These sequences can be viewed as trajectories of random walks which spends half *
@@ -21,64 +57,100 @@ typedef long long int64;
  *     a Dyck Path of length 2k; Dyck Paths corresponding to subsequences of 0s    *
  *     are reflected over OX                                                       *
  *   - as a result we get a random sequence of bits of length 4n satisfying [P1]   *
- *                                                                                 * 
- * The implementation is based on vector of booleans                               *
- *    - an optimized version of the vector container                               *
- *      for storing binary sequences (1 bit per each bool)                         *
+ *                                                                                 *
+ * The implementation is based on PackedBits (64 bits per word); bits are         *
+ * shuffled with the same random numbers as std::shuffle would use, so the paths  *
+ * are the same as the ones of the former implementation on vector<bool>.          *
+ *                                                                                 *
+ * In the streaming mode (startStream, nextStreamWord) the path of the second      *
+ * algorithm is produced 64 bits at a time without storing it:                     *
+ *   - the 2nd half of the control sequence is sampled bit by bit - a 1 with       *
+ *     probability (1s left) / (bits left), which gives a random permutation of    *
+ *     complements of the 1st half                                                 *
+ *   - only the lengths of subpaths are kept (about sqrt(n) of them)               *
+ *   - each Dyck Path is sampled step by step - an up-step at height h with r      *
+ *     steps left has probability (r - h)(h + 2) / (2r(h + 1))                     *
+ * The distribution of paths is the same, the paths themselves are different.      *
+ * (As in generateBitSequence2, a last subpath below 0 of the control sequence     *
+ * gets no Dyck Path - such a path ends with 0s, see nextDyckBit.)                 *
  ***********************************************************************************/
 class FlawedPath {
 	public:
 		FlawedPath();
-	
+
 		FlawedPath(int64 seed);
-		
+
 		void setSeed(int64 seed);
-		
-		std::vector<bool>* generateBitSequence(int64 path_n);
-		
-		std::vector<bool>* generateBitSequence(int64 path_n, int64 seed);
-		
-		std::vector<bool>* generateBitSequence2(int64 path_n);
-		
-		std::vector<bool>* generateBitSequence2(int64 path_n, int64 seed);
-		
-		std::vector<bool>::iterator itPathBegin();
-		
-		std::vector<bool>::iterator itPathEnd();
-		
+
+		const PackedBits* generateBitSequence(int64 path_n);
+
+		const PackedBits* generateBitSequence(int64 path_n, int64 seed);
+
+		const PackedBits* generateBitSequence2(int64 path_n);
+
+		const PackedBits* generateBitSequence2(int64 path_n, int64 seed);
+
+		int64 pathLength() const;
+
+		uint64 getPathWord(int64 pos) const;
+
+		void startStream(int64 path_n);
+
+		void startStream(int64 path_n, int64 seed);
+
+		bool streamEnded() const;
+
+		uint64 nextStreamWord();
+
 		void prettyPrintPath();
-        
+
         void printBitsAscii();
-        
-		
+
+
 	private:
 		int64 n;
-		std::vector<bool> flawed_bitseq; // Sequence of generated bits of length 4n
-		std::vector<bool> ctrl_bitseq; // Control sequence - random permutation of n 0s and n 1s
+		PackedBits flawed_bitseq; // Sequence of generated bits of length 4n
+		PackedBits ctrl_bitseq; // Control sequence - random permutation of n 0s and n 1s
+		PackedBits rotate_buf; // used by swapSubpaths
 		std::mt19937_64 mt_eng; // the underlying PRNG - Mersenne Twister MT19937 (64-bit)
-		
+
+		// state of the streaming mode
+		int64 stream_n = 0;
+		int64 stream_pos = 0;     // number of bits of the path generated so far
+		uint64 rnd_bits;          // random bits of the 1st half of the control sequence
+		int64 ctrl_ones_left;     // 1s left for the 2nd half of the control sequence
+		int64 ctrl_lvl;
+		int64 sub_len;            // length of the current subpath of the control sequence
+		int sub_end;              // +1 (-1) if the walk came back to 0 from above (below)
+		std::vector<int64> sub_lengths;
+		size_t sub_ind;           // the subpath of the current Dyck Path
+		int64 dyck_left;          // steps left in the current Dyck Path
+		int64 dyck_lvl;
+		bool dyck_below;          // the current Dyck Path is reflected over OX
+
 		void initSequences();
-		
+
 		void initSequences2();
-		
+
 		void initCtrlSeq();
-		
+
 		void initCtrlSeq2();
-		
-		void shuffleBitseq(std::vector<bool>::iterator begin, std::vector<bool>::iterator end);
-		
-		void generateDyckPath(std::vector<bool>::iterator begin, std::vector<bool>::iterator end, bool b);
-		
-		std::vector<bool>::iterator firstLowestLevelIterator(std::vector<bool>::iterator begin, 
-														std::vector<bool>::iterator end);
-													
-		std::pair<std::vector<bool>::iterator, int64>
-			firstLowestLevel(std::vector<bool>::iterator begin, std::vector<bool>::iterator end);
-		
+
+		void shuffleBitseq(PackedBits& seq, int64 begin, int64 end);
+
+		void generateDyckPath(int64 begin, int64 end, bool b);
+
+		int64 firstLowestLevelIndex(const PackedBits& seq, int64 begin, int64 end);
+
+		std::pair<int64, int64> firstLowestLevel(const PackedBits& seq, int64 begin, int64 end);
+
 		void findSubpathLenghts(std::vector<int64>& dyck_lenghts);
-		
-		void swapSubpaths(std::vector<bool>::iterator begin, std::vector<bool>::iterator end,
-							std::vector<bool>::iterator idx);
+
+		void swapSubpaths(int64 begin, int64 end, int64 idx);
+
+		bool nextCtrlBit();
+
+		bool nextDyckBit();
 
 };
 
@@ -0,0 +1,765 @@
+#include "ResultHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+/***********************************************************************************
+ *  PUBLIC METHODS                                                                 *
+ ***********************************************************************************/
+ResultHistogram::ResultHistogram(const char* path) {
+	ifstream in(path);
+	if(!in) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		exit(1);
+	}
+	total = 0;
+	logLength = 0;
+	earlyStopped = false;
+	string line;
+	bool ok = true;
+	while(ok && getline(in, line)) {
+		istringstream words(line);
+		string key;
+		words >> key;
+		if(key == "prng") {
+			// with its options, e.g. "FlawedDyckMT -f 7"
+			getline(words >> ws, prngName);
+		}
+		else if(key == "test") {
+			string name;
+			words >> name;
+			ok = name == "asin" || name == "lil";
+			type = name == "asin" ? TEST_ASIN : TEST_LIL;
+		}
+		else if(key == "loglength") {
+			words >> logLength;
+		}
+		else if(key == "seeds") {
+			getline(words >> ws, seedSource);
+			seedSource = seedSource == "default" ? "" : seedSource;
+		}
+		else if(key == "total") {
+			words >> total;
+		}
+		else if(key == "range") {
+			int64 first = -1, count = -1;
+			words >> first >> count;
+			ok = first >= 0 && count >= 0;
+			ranges.push_back(make_pair(first, count));
+		}
+		else if(key == "earlystopped") {
+			earlyStopped = true;
+		}
+		else if(key == "checkpoints") {
+			string label;
+			while(words >> label) {
+				labels.push_back(label);
+				checkPoints.push_back(1LL << atoi(label.c_str() + 2));
+			}
+		}
+		else if(!key.empty()) {
+			// counts of the next check point: "label: c_1 ... c_42"
+			ok = counts.size() < labels.size() && key == labels[counts.size()] + ":";
+			vector<int64> c(nrOfParts, -1);
+			for(int i = 0; i < nrOfParts; ++i) {
+				words >> c[i];
+			}
+			ok = ok && c[nrOfParts - 1] >= 0;
+			counts.push_back(c);
+		}
+	}
+	if(!ok || labels.empty() || counts.size() != labels.size()) {
+		fprintf(stderr, "%s is not a valid histogram file\n", path);
+		exit(1);
+	}
+}
+
+ResultHistogram::ResultHistogram(TestType type, const SeqAnalyzer& analyzer, int logLength, const string& prngName)
+	: type(type), logLength(logLength), prngName(prngName), total(0), earlyStopped(false) {
+	for(int i = 0; i < analyzer.getNrOfCheckPoints(); ++i) {
+		labels.push_back(analyzer.getCheckPointLabel(i));
+		checkPoints.push_back(analyzer.getCheckPoint(i));
+	}
+	counts.assign(labels.size(), vector<int64>(nrOfParts, 0));
+}
+
+// the partition of a fine histogram, the values in a bin are represented by its left end
+ResultHistogram::ResultHistogram(const FineHistogram& fine)
+	: type(fine.type), logLength(fine.logLength), prngName(fine.prngName), seedSource(fine.seedSource),
+	  total(fine.total), ranges(fine.ranges), earlyStopped(fine.earlyStopped), labels(fine.labels), checkPoints(fine.checkPoints) {
+	counts.assign(labels.size(), vector<int64>(nrOfParts, 0));
+	for(size_t i = 0; i < counts.size(); ++i) {
+		const uint32_t* c = &fine.counts[i * FineHistogram::nrOfBins];
+		for(int b = 0; b < FineHistogram::nrOfBins; ++b) {
+			if(c[b] > 0) {
+				counts[i][getInterval(fine.getBinStart(b))] += c[b];
+			}
+		}
+	}
+}
+
+// the histogram is of the count seeds starting at the first one, out of total seeds of the run
+void ResultHistogram::setSeeds(const string& seedSource, int64 first, int64 count, int64 total) {
+	this->seedSource = seedSource;
+	this->total = total;
+	ranges.assign(1, make_pair(first, count));
+}
+
+// the run was stopped by SequentialTest, the ranges are of the seeds processed until then
+void ResultHistogram::setEarlyStopped() {
+	earlyStopped = true;
+}
+
+void ResultHistogram::addResult(const vector<double>& res) {
+	for(size_t i = 0; i < res.size(); ++i) {
+		++counts[i][getInterval(res[i])];
+	}
+}
+
+// counts of another (disjoint) range of seeds of the same run
+void ResultHistogram::add(const ResultHistogram& other) {
+	if(type != other.type || logLength != other.logLength || prngName != other.prngName
+			|| seedSource != other.seedSource || total != other.total || labels != other.labels) {
+		fprintf(stderr, "ResultHistogram: histograms of different runs cannot be merged\n");
+		exit(1);
+	}
+	for(auto& r : other.ranges) {
+		for(auto& s : ranges) {
+			if(r.first < s.first + s.second && s.first < r.first + r.second) {
+				fprintf(stderr, "ResultHistogram: seeds %lld..%lld are counted twice\n",
+				        max(r.first, s.first), min(r.first + r.second, s.first + s.second) - 1);
+				exit(1);
+			}
+		}
+	}
+	ranges.insert(ranges.end(), other.ranges.begin(), other.ranges.end());
+	sort(ranges.begin(), ranges.end());
+	earlyStopped = earlyStopped || other.earlyStopped;
+	for(size_t i = 0; i < counts.size(); ++i) {
+		for(int j = 0; j < nrOfParts; ++j) {
+			counts[i][j] += other.counts[i][j];
+		}
+	}
+}
+
+void ResultHistogram::write(const char* path) const {
+	FILE* file = fopen(path, "w");
+	if(!file) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		exit(1);
+	}
+	fprintf(file, "prng %s\n", prngName.c_str());
+	fprintf(file, "test %s\n", type == TEST_ASIN ? "asin" : "lil");
+	fprintf(file, "loglength %d\n", logLength);
+	fprintf(file, "seeds %s\n", seedSource.empty() ? "default" : seedSource.c_str());
+	fprintf(file, "total %lld\n", total);
+	for(auto& r : ranges) {
+		fprintf(file, "range %lld %lld\n", r.first, r.second);
+	}
+	if(earlyStopped) {
+		fprintf(file, "earlystopped\n");
+	}
+	fprintf(file, "checkpoints");
+	for(auto& label : labels) {
+		fprintf(file, " %s", label.c_str());
+	}
+	fprintf(file, "\n");
+	for(size_t i = 0; i < counts.size(); ++i) {
+		fprintf(file, "%s:", labels[i].c_str());
+		for(int j = 0; j < nrOfParts; ++j) {
+			fprintf(file, " %lld", counts[i][j]);
+		}
+		fprintf(file, "\n");
+	}
+	fclose(file);
+}
+
+int64 ResultHistogram::getNrOfSeqs() const {
+	int64 n = 0;
+	for(int j = 0; j < nrOfParts; ++j) {
+		n += counts[0][j];
+	}
+	return n;
+}
+
+int64 ResultHistogram::getNrOfMissingSeeds() const {
+	int64 n = total;
+	for(auto& r : ranges) {
+		n -= r.second;
+	}
+	return n;
+}
+
+bool ResultHistogram::isEarlyStopped() const {
+	return earlyStopped;
+}
+
+/***********************************************************************************
+ *  Distances (jl/modules/MeasureModule.jl)                                        *
+ ***********************************************************************************/
+static double distTV(const vector<double>& u, const vector<double>& v) {
+	double d = 0;
+	for(size_t i = 0; i < u.size(); ++i) {
+		d += max(0.0, u[i] - v[i]);
+	}
+	return d;
+}
+
+static double distSep(const vector<double>& u, const vector<double>& v) {
+	auto isZero = [](double x) { return fabs(x) < 0.0000001; };
+	double d = -numeric_limits<double>::infinity();
+	for(size_t i = 0; i < u.size(); ++i) {
+		d = max(d, isZero(v[i]) ? (isZero(u[i]) ? 0.0 : 1.0) : 1.0 - u[i] / v[i]);
+	}
+	return d;
+}
+
+// regularized upper incomplete gamma function Q(a, x)
+static double gammaQ(double a, double x) {
+	if(x <= 0) {
+		return 1.0;
+	}
+	const double eps = 1e-15;
+	const double norm = exp(-x + a * log(x) - lgamma(a));
+	if(x < a + 1) { // series of P(a, x)
+		double ap = a;
+		double del = 1.0 / a;
+		double sum = del;
+		while(fabs(del) > fabs(sum) * eps) {
+			ap += 1;
+			del *= x / ap;
+			sum += del;
+		}
+		return 1.0 - sum * norm;
+	}
+	// continued fraction of Q(a, x) (modified Lentz)
+	const double tiny = 1e-300;
+	double b = x + 1 - a;
+	double c = 1 / tiny;
+	double d = 1 / b;
+	double h = d;
+	for(int i = 1; i < 10000; ++i) {
+		double an = -i * (i - a);
+		b += 2;
+		d = an * d + b;
+		d = fabs(d) < tiny ? tiny : d;
+		c = b + an / c;
+		c = fabs(c) < tiny ? tiny : c;
+		d = 1 / d;
+		double del = d * c;
+		h *= del;
+		if(fabs(del - 1) < eps) {
+			break;
+		}
+	}
+	return h * norm;
+}
+
+// p-value of the chi-square test of m observations (chisqTest)
+static double chisqTest(int64 m, const vector<double>& obs, const vector<double>& exp) {
+	double t = 0;
+	int df = obs.size() - 1;
+	for(size_t i = 0; i < obs.size(); ++i) {
+		if(exp[i] < 0.0000001) {
+			--df;
+			continue;
+		}
+		double O = m * obs[i];
+		double E = m * exp[i];
+		t += (O - E) * (O - E) / E;
+	}
+	return gammaQ(df / 2.0, t / 2);
+}
+
+// string(round(x, 4)) of Julia - the shortest representation, at least one decimal digit
+static string juliaString(double x) {
+	double y = rint(x * 10000) / 10000;
+	char buf[64];
+	if(fabs(y) < 1e6) {
+		snprintf(buf, sizeof(buf), "%.4f", y);
+		string s = buf;
+		s.erase(s.find_last_not_of('0') + 1);
+		return s.back() == '.' ? s + "0" : s;
+	}
+	int prec = 0;
+	do {
+		snprintf(buf, sizeof(buf), "%.*e", prec++, y);
+	} while(strtod(buf, NULL) != y);
+	string s = buf;
+	size_t e = s.find('e');
+	string mant = s.substr(0, e);
+	int exp10 = atoi(s.c_str() + e + 1);
+	return (mant.find('.') == string::npos ? mant + ".0" : mant) + "e" + to_string(exp10);
+}
+
+// displayLine of ResultPresenter with the display of ResultReader.jl
+static void displayLine(FILE* out, const vector<string>& words) {
+	const int wordSize = 4 + 3;
+	int balance = 0;
+	for(size_t i = 0; i < words.size(); ++i) {
+		balance += wordSize - (int) words[i].size();
+		if(balance > 0) {
+			fprintf(out, "%s", string(balance, ' ').c_str());
+			balance = 0;
+		}
+		fprintf(out, "%s%s", words[i].c_str(), i + 1 < words.size() ? " & " : "\\\\ \\hline\n");
+	}
+}
+
+// the table of ResultReader.jl (the first two check points are skipped)
+void ResultHistogram::printTable(FILE* out) const {
+	const int n = labels.size();
+	const int skip = min(2, n - 1);
+	const int64 m = getNrOfSeqs();
+	vector<string> tv(1, "tv"), sep1(1, "sep1"), sep2(1, "sep2"), pval(1, "p-val");
+	for(int i = skip; i < n; ++i) {
+		vector<double> emp(nrOfParts);
+		for(int j = 0; j < nrOfParts; ++j) {
+			emp[j] = (double) counts[i][j] / m;
+		}
+		vector<double> ideal = getIdealMeasure(i);
+		tv.push_back(juliaString(distTV(emp, ideal)));
+		sep1.push_back(juliaString(distSep(emp, ideal)));
+		sep2.push_back(juliaString(distSep(ideal, emp)));
+		pval.push_back(juliaString(chisqTest(m, emp, ideal)));
+	}
+	vector<string> header(1, "");
+	header.insert(header.end(), labels.begin() + skip, labels.end());
+	displayLine(out, header);
+	displayLine(out, tv);
+	displayLine(out, sep1);
+	displayLine(out, sep2);
+	displayLine(out, pval);
+}
+
+/***********************************************************************************
+ *  PRIVATE METHODS                                                                *
+ ***********************************************************************************/
+static int64 floorDiv(int64 a, int64 b) {
+	return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+/*
+ * The interval [b_i, b_{i+1}) of the value rounded to 4 digits, i.e. m / 10^4.
+ * The breaks are b_0 = -inf, b_42 = inf and for j = 1..41
+ *   - asin: b_j = -1/80 + (j-1)/40 = (2j - 3) * 125 / 10^4
+ *   - lil:  b_j = -1 + (j-1)/20 = (j - 21) * 500 / 10^4
+ * so the interval is found exactly with integers.
+ */
+int ResultHistogram::getInterval(double val) const {
+	int64 m = llrint(val * 10000);
+	int64 i = type == TEST_ASIN ? floorDiv(m + 375, 250) : floorDiv(m, 500) + 21;
+	return max<int64>(0, min<int64>(nrOfParts - 1, i));
+}
+
+vector<double> ResultHistogram::getBreaks() const {
+	vector<double> breaks(nrOfParts + 1);
+	breaks[0] = -numeric_limits<double>::infinity();
+	breaks[nrOfParts] = numeric_limits<double>::infinity();
+	for(int j = 1; j < nrOfParts; ++j) {
+		breaks[j] = type == TEST_ASIN ? (2 * j - 3) / 80.0 : (j - 21) / 20.0;
+	}
+	return breaks;
+}
+
+// makeIdealAsinMeasure (makeIdealLilMeasure) of the check point
+vector<double> ResultHistogram::getIdealMeasure(int cp_ind) const {
+	vector<double> breaks = getBreaks();
+	vector<double> vals(nrOfParts);
+	const double s = sqrt(2 * log(log((double) checkPoints[cp_ind])));
+	auto asinCdf = [](double a) { return a < 0 ? 0.0 : (a > 1 ? 1.0 : 2.0 / M_PI * asin(sqrt(a))); };
+	auto normalCdf = [](double a) { return 0.5 * erfc(-a / sqrt(2.0)); };
+	for(int i = 0; i < nrOfParts; ++i) {
+		double a = breaks[i];
+		double b = breaks[i + 1];
+		vals[i] = type == TEST_ASIN ? asinCdf(b) - asinCdf(a) : normalCdf(b * s) - normalCdf(a * s);
+	}
+	return vals;
+}
+
+// C(2j, j) / 4^j - the probability that a walk is at 0 after 2j steps
+static double centralBinomial(int64 j) {
+	if(j < 1024) {
+		double u = 1;
+		for(int64 i = 0; i < j; ++i) {
+			u *= (2 * i + 1) / (2.0 * i + 2);
+		}
+		return u;
+	}
+	const double x = 1.0 / j;
+	return (1 - x / 8 + x * x / 128 + 5 * x * x * x / 1024) / sqrt(M_PI * j);
+}
+
+/*
+ * The measure of the intervals for a good PRNG, i.e. of the statistic of a walk of
+ * exactly cp = checkPoints[cp_ind] steps, rounded by getInterval as addResult does:
+ *   - asin: 2k steps above the line with probability u(k) u(n - k), n = cp / 2,
+ *     u(k) = C(2k, k) / 4^k (the discrete arcsine law); exact for k or n - k below
+ *     exactTerms, for the others the sum of the interval is the integral of the
+ *     asymptotic density 1 / (pi sqrt(k (n - k))) over [first - 1/2, last + 1/2],
+ *     which differs from it by less than 1 / (4 exactTerms)
+ *   - lil: 2j - cp ones more than zeros with probability C(cp, j) / 2^cp, exact up
+ *     to the tails below 10^-20
+ */
+vector<double> ResultHistogram::getExactMeasure(int cp_ind) const {
+	const int64 exactTerms = 1 << 20;
+	const int64 cp = checkPoints[cp_ind];
+	const int64 n = cp / 2;
+	vector<double> vals(nrOfParts, 0.0);
+	if(type == TEST_LIL) {
+		const double len = static_cast<double>(cp);
+		auto add = [&](int64 ones, double p) {
+			double s_star = (2 * ones - cp) / sqrt(len); // SeqAnalyzer::getSlil
+			vals[getInterval(s_star / sqrt(2 * log(log(len))))] += p;
+		};
+		double p = centralBinomial(n);
+		add(n, p);
+		for(int64 d = 1; d <= n && p > 1e-20; ++d) {
+			p *= (double) (n - d + 1) / (n + d);
+			add(n + d, p);
+			add(n - d, p);
+		}
+		return vals;
+	}
+	auto interval = [&](int64 k) { return getInterval(static_cast<double>(2 * k) / cp); };
+	const int64 head = min(n + 1, exactTerms);
+	const bool exact = n + 1 <= 2 * head;
+	// u(k) forwards, u(n - k) backwards
+	double u = 1;
+	double v = centralBinomial(n);
+	for(int64 k = 0; k < (exact ? n + 1 : head); ++k) {
+		vals[interval(k)] += u * v;
+		if(!exact) {
+			vals[interval(n - k)] += u * v;
+		}
+		u *= (2 * k + 1) / (2.0 * k + 2);
+		v *= (2.0 * (n - k)) / (2 * (n - k) - 1);
+	}
+	if(exact) {
+		return vals;
+	}
+	auto cdf = [&](double t) { return 2.0 / M_PI * asin(sqrt(t / n)); };
+	for(int64 first = head, last = n - head; first <= last; ) {
+		// the last k of the interval of first (interval is nondecreasing in k)
+		const int i = interval(first);
+		int64 lo = first, hi = last;
+		while(lo < hi) {
+			int64 mid = lo + (hi - lo + 1) / 2;
+			if(interval(mid) == i) {
+				lo = mid;
+			}
+			else {
+				hi = mid - 1;
+			}
+		}
+		vals[i] += cdf(lo + 0.5) - cdf(first - 0.5);
+		first = lo + 1;
+	}
+	return vals;
+}
+
+/***********************************************************************************
+ *  FineHistogram                                                                  *
+ ***********************************************************************************/
+// a name (of the PRNG or of the seeds) of the header has to fit into its field with the terminating 0,
+// names cut to fit would let histograms of different runs be merged
+static void checkFits(size_t size, const string& name, const char* what) {
+	if(name.size() >= size) {
+		fprintf(stderr, "FineHistogram: %s %s is longer than %d characters\n", what, name.c_str(), (int) size - 1);
+		exit(1);
+	}
+}
+
+FineHistogram::FineHistogram(const char* path) {
+	FILE* file = fopen(path, "rb");
+	if(!file) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		exit(1);
+	}
+	FineHistogramHeader header;
+	bool ok = fread(&header, sizeof(header), 1, file) == 1
+	          && strcmp(header.magic, "PRNGHST") == 0
+	          && header.version == FineHistogramHeader::currentVersion
+	          && header.nrOfBins == (uint32_t) nrOfBins
+	          && (header.test == TEST_ASIN || header.test == TEST_LIL);
+	if(ok) {
+		type = (TestType) header.test;
+		logLength = header.logLength;
+		header.prngName[sizeof(header.prngName) - 1] = 0;
+		header.seedSource[sizeof(header.seedSource) - 1] = 0;
+		prngName = header.prngName;
+		seedSource = header.seedSource;
+		total = header.total;
+		earlyStopped = header.earlyStopped != 0;
+		lo = header.lo;
+		hi = header.hi;
+		checkPoints.resize(header.nrOfCheckPoints);
+		ranges.resize(header.nrOfRanges);
+		counts.resize((size_t) header.nrOfCheckPoints * nrOfBins);
+		ok = fread(checkPoints.data(), sizeof(int64), checkPoints.size(), file) == checkPoints.size()
+		     && fread(ranges.data(), sizeof(ranges[0]), ranges.size(), file) == ranges.size()
+		     && fread(counts.data(), sizeof(uint32_t), counts.size(), file) == counts.size();
+	}
+	fclose(file);
+	for(size_t i = 0; ok && i < checkPoints.size(); ++i) {
+		ok = checkPoints[i] > 0 && (checkPoints[i] & (checkPoints[i] - 1)) == 0;
+		labels.push_back("2^" + to_string(63 - __builtin_clzll(checkPoints[i])));
+	}
+	if(!ok || checkPoints.empty()) {
+		fprintf(stderr, "%s is not a valid fine histogram file\n", path);
+		exit(1);
+	}
+}
+
+FineHistogram::FineHistogram(TestType type, const SeqAnalyzer& analyzer, int logLength, const string& prngName)
+	: type(type), logLength(logLength), prngName(prngName), total(0), earlyStopped(false) {
+	checkFits(sizeof(FineHistogramHeader::prngName), prngName, "the name of the PRNG");
+	lo = type == TEST_ASIN ? 0 : -4;
+	hi = type == TEST_ASIN ? 1 : 4;
+	for(int i = 0; i < analyzer.getNrOfCheckPoints(); ++i) {
+		labels.push_back(analyzer.getCheckPointLabel(i));
+		checkPoints.push_back(analyzer.getCheckPoint(i));
+	}
+	counts.assign(checkPoints.size() * nrOfBins, 0);
+}
+
+bool FineHistogram::isFineHistogram(const char* path) {
+	char magic[8] = {0};
+	FILE* file = fopen(path, "rb");
+	if(file) {
+		fread(magic, 1, sizeof(magic) - 1, file);
+		fclose(file);
+	}
+	return strcmp(magic, "PRNGHST") == 0;
+}
+
+void FineHistogram::setSeeds(const string& seedSource, int64 first, int64 count, int64 total) {
+	checkFits(sizeof(FineHistogramHeader::seedSource), seedSource, "the path to seeds");
+	this->seedSource = seedSource;
+	this->total = total;
+	ranges.assign(1, make_pair(first, count));
+}
+
+// the run was stopped by SequentialTest, the ranges are of the seeds processed until then
+void FineHistogram::setEarlyStopped() {
+	earlyStopped = true;
+}
+
+void FineHistogram::clear() {
+	fill(counts.begin(), counts.end(), 0);
+}
+
+// for asin the bin of above / cp is computed exactly, with integers
+void FineHistogram::addSequence(const SeqAnalyzer& analyzer) {
+	for(size_t i = 0; i < checkPoints.size(); ++i) {
+		int bin = type == TEST_ASIN ? min<int64>(nrOfBins - 1, analyzer.getAboveTheLine(i) * nrOfBins / checkPoints[i])
+		                            : getBin(analyzer.getSlil(i));
+		++counts[i * nrOfBins + bin];
+	}
+}
+
+// results of SeqAnalyzer::getResults; above / cp is a binary fraction, so its bin is the same as in addSequence
+void FineHistogram::addResult(const vector<double>& res) {
+	for(size_t i = 0; i < res.size(); ++i) {
+		++counts[i * nrOfBins + getBin(res[i])];
+	}
+}
+
+// counts of the same seeds, e.g. of another worker thread
+void FineHistogram::addCounts(const FineHistogram& other) {
+	for(size_t i = 0; i < counts.size(); ++i) {
+		if(counts[i] + (uint64) other.counts[i] > UINT32_MAX) {
+			fprintf(stderr, "FineHistogram: too many sequences in a bin\n");
+			exit(1);
+		}
+		counts[i] += other.counts[i];
+	}
+}
+
+// counts of another (disjoint) range of seeds of the same run
+void FineHistogram::add(const FineHistogram& other) {
+	if(type != other.type || logLength != other.logLength || prngName != other.prngName
+			|| seedSource != other.seedSource || total != other.total || checkPoints != other.checkPoints) {
+		fprintf(stderr, "FineHistogram: histograms of different runs cannot be merged\n");
+		exit(1);
+	}
+	for(auto& r : other.ranges) {
+		for(auto& s : ranges) {
+			if(r.first < s.first + s.second && s.first < r.first + r.second) {
+				fprintf(stderr, "FineHistogram: seeds %lld..%lld are counted twice\n",
+				        max(r.first, s.first), min(r.first + r.second, s.first + s.second) - 1);
+				exit(1);
+			}
+		}
+	}
+	ranges.insert(ranges.end(), other.ranges.begin(), other.ranges.end());
+	sort(ranges.begin(), ranges.end());
+	earlyStopped = earlyStopped || other.earlyStopped;
+	addCounts(other);
+}
+
+void FineHistogram::write(const char* path) const {
+	FILE* file = fopen(path, "wb");
+	if(!file) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		exit(1);
+	}
+	FineHistogramHeader header;
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, "PRNGHST");
+	header.version = FineHistogramHeader::currentVersion;
+	header.test = type;
+	header.logLength = logLength;
+	header.nrOfCheckPoints = checkPoints.size();
+	header.nrOfBins = nrOfBins;
+	header.nrOfRanges = ranges.size();
+	header.total = total;
+	header.earlyStopped = earlyStopped;
+	header.lo = lo;
+	header.hi = hi;
+	checkFits(sizeof(header.prngName), prngName, "the name of the PRNG");
+	checkFits(sizeof(header.seedSource), seedSource, "the path to seeds");
+	strcpy(header.prngName, prngName.c_str());
+	strcpy(header.seedSource, seedSource.c_str());
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+	          && fwrite(checkPoints.data(), sizeof(int64), checkPoints.size(), file) == checkPoints.size()
+	          && fwrite(ranges.data(), sizeof(ranges[0]), ranges.size(), file) == ranges.size()
+	          && fwrite(counts.data(), sizeof(uint32_t), counts.size(), file) == counts.size();
+	if(fclose(file) != 0 || !ok) {
+		fprintf(stderr, "Couldn't write %s\n", path);
+		exit(1);
+	}
+}
+
+int64 FineHistogram::getNrOfSeqs() const {
+	int64 n = 0;
+	for(int b = 0; b < nrOfBins; ++b) {
+		n += counts[b];
+	}
+	return n;
+}
+
+int64 FineHistogram::getNrOfMissingSeeds() const {
+	int64 n = total;
+	for(auto& r : ranges) {
+		n -= r.second;
+	}
+	return n;
+}
+
+bool FineHistogram::isEarlyStopped() const {
+	return earlyStopped;
+}
+
+// counts in nrOfParts (dividing nrOfBins) equal intervals of [lo, hi)
+vector<int64> FineHistogram::rebin(int cp_ind, int nrOfParts) const {
+	if(nrOfParts <= 0 || nrOfBins % nrOfParts != 0) {
+		fprintf(stderr, "FineHistogram: the number of parts has to divide %d\n", nrOfBins);
+		exit(1);
+	}
+	const int binsPerPart = nrOfBins / nrOfParts;
+	vector<int64> parts(nrOfParts, 0);
+	for(int b = 0; b < nrOfBins; ++b) {
+		parts[b / binsPerPart] += counts[cp_ind * nrOfBins + b];
+	}
+	return parts;
+}
+
+// the intervals of rebin and their counts, a line for every check point
+void FineHistogram::printRebinned(FILE* out, int nrOfParts) const {
+	vector<vector<int64>> parts;
+	for(size_t i = 0; i < checkPoints.size(); ++i) {
+		parts.push_back(rebin(i, nrOfParts));
+	}
+	fprintf(out, "test %s, %d intervals of [%g, %g)\n", type == TEST_ASIN ? "asin" : "lil", nrOfParts, lo, hi);
+	for(size_t i = 0; i < checkPoints.size(); ++i) {
+		fprintf(out, "%s:", labels[i].c_str());
+		for(int j = 0; j < nrOfParts; ++j) {
+			fprintf(out, " %lld", parts[i][j]);
+		}
+		fprintf(out, "\n");
+	}
+}
+
+int FineHistogram::getBin(double val) const {
+	double b = floor((val - lo) / (hi - lo) * nrOfBins);
+	return (int) max(0.0, min(nrOfBins - 1.0, b));
+}
+
+double FineHistogram::getBinStart(int bin) const {
+	return lo + (hi - lo) * bin / nrOfBins;
+}
+
+/***********************************************************************************
+ *  SequentialTest                                                                 *
+ ***********************************************************************************/
+SequentialTest::SequentialTest(TestType type, const SeqAnalyzer& analyzer, int logLength, const string& prngName, double alpha)
+	: histogram(type, analyzer, logLength, prngName), alpha(alpha), look(0), nextLook(firstLook), rejected(false),
+	  rejectedTV(0), rejectedPVal(0), rejectedLevel(0) {
+	for(size_t i = 0; i < histogram.labels.size(); ++i) {
+		measures.push_back(histogram.getExactMeasure(i));
+	}
+}
+
+bool SequentialTest::addResult(const vector<double>& res) {
+	histogram.addResult(res);
+	if(rejected || histogram.getNrOfSeqs() < nextLook) {
+		return false;
+	}
+	nextLook *= 2;
+	++look;
+	return test(alpha / pow(2.0, look));
+}
+
+bool SequentialTest::hasRejected() const {
+	return rejected;
+}
+
+int64 SequentialTest::getNrOfSeqs() const {
+	return histogram.getNrOfSeqs();
+}
+
+void SequentialTest::printSummary(FILE* out) const {
+	const char* test = histogram.type == TEST_ASIN ? "asin" : "lil";
+	if(!rejected) {
+		fprintf(out, "SequentialTest (%s): no decisive failure in %lld sequences (%d looks, alpha %g)\n",
+		        test, getNrOfSeqs(), look, alpha);
+		return;
+	}
+	fprintf(out, "SequentialTest (%s): stopped early after %lld sequences (look %d, alpha %g): check point %s, "
+	        "tv %.4f, p-val %.3g < %.3g\n", test, getNrOfSeqs(), look, alpha, rejectedLabel.c_str(),
+	        rejectedTV, rejectedPVal, rejectedLevel);
+}
+
+// rejects the measure of a good PRNG if any check point of printTable does at level / (number of such check points)
+bool SequentialTest::test(double level) {
+	const int n = histogram.labels.size();
+	const int skip = min(2, n - 1);
+	const int64 m = histogram.getNrOfSeqs();
+	const double a = level / (n - skip);
+	const double tvBound = sqrt((double) ResultHistogram::nrOfParts / m) / 2 + sqrt(log(1 / a) / (2.0 * m));
+	for(int i = skip; i < n; ++i) {
+		vector<double> emp(ResultHistogram::nrOfParts);
+		for(int j = 0; j < ResultHistogram::nrOfParts; ++j) {
+			emp[j] = (double) histogram.counts[i][j] / m;
+		}
+		const double tv = distTV(emp, measures[i]);
+		const double pval = chisqTest(m, emp, measures[i]);
+		if(tv > tvBound && pval < a) {
+			rejected = true;
+			rejectedLabel = histogram.labels[i];
+			rejectedTV = tv;
+			rejectedPVal = pval;
+			rejectedLevel = a;
+			return true;
+		}
+	}
+	return false;
+}
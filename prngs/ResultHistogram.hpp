@@ -0,0 +1,228 @@
+#ifndef _RESULT_HISTOGRAM_H_
+#define _RESULT_HISTOGRAM_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SeqAnalyzer.hpp"
+
+class FineHistogram;
+class SequentialTest;
+
+/***********************************************************************************
+ * Native counterpart of MeasureCreator and ResultPresenter (jl/modules)           *
+ *                                                                                 *
+ * Values of the statistic, rounded to 4 digits (as fillBuckets does), are counted *
+ * for every check point in the 42 intervals of makePartitionForAsin               *
+ * (makePartitionForLil). The counts of disjoint ranges of seeds, e.g. shards of   *
+ * a run (-shard in prng.cpp), are merged by adding them up, and the table of      *
+ * distances between the empirical and the ideal measures (tv, sep1, sep2, p-val)  *
+ * is the one printed by jl/modules/ResultReader.jl.                               *
+ *                                                                                 *
+ * The file is a text file: metadata (prng, test, log2 of length, seeds, ranges    *
+ * of seeds, "earlystopped" if the run was stopped by SequentialTest) followed by  *
+ * a line of counts for every check point.                                         *
+ ***********************************************************************************/
+class ResultHistogram {
+	friend class SequentialTest;
+
+	public:
+		static const int nrOfParts = 42;
+
+		ResultHistogram(const char* path);
+
+		ResultHistogram(TestType type, const SeqAnalyzer& analyzer, int logLength, const std::string& prngName);
+
+		ResultHistogram(const FineHistogram& fine);
+
+		void setSeeds(const std::string& seedSource, int64 first, int64 count, int64 total);
+
+		void setEarlyStopped();
+
+		void addResult(const std::vector<double>& res);
+
+		void add(const ResultHistogram& other);
+
+		void write(const char* path) const;
+
+		int64 getNrOfSeqs() const;
+
+		int64 getNrOfMissingSeeds() const;
+
+		bool isEarlyStopped() const;
+
+		void printTable(FILE* out) const;
+
+	private:
+		TestType type;
+		int logLength;
+		std::string prngName;
+		std::string seedSource;
+		int64 total;                                   // number of seeds of the whole run
+		std::vector<std::pair<int64, int64>> ranges;   // (first, count) of seeds counted
+		bool earlyStopped;
+		std::vector<std::string> labels;
+		std::vector<int64> checkPoints;
+		std::vector<std::vector<int64>> counts;        // counts[cp_ind][interval]
+
+		int getInterval(double val) const;
+
+		std::vector<double> getBreaks() const;
+
+		std::vector<double> getIdealMeasure(int cp_ind) const;
+
+		std::vector<double> getExactMeasure(int cp_ind) const;
+};
+
+/***********************************************************************************
+ * Histogram of the values of the statistic in nrOfBins = 2^16 equal bins of       *
+ * [lo, hi) for every check point: [0, 1] for asin (the last bin is closed) and    *
+ * [-4, 4) for lil (values outside go to the first or the last bin).               *
+ *                                                                                 *
+ * For asin the bin is computed from the exact number of steps above the line, so  *
+ * for check points up to 2^16 every bin holds a single value of the statistic.    *
+ * Any partition into intervals with ends at multiples of 2^-16 (e.g. rebin with   *
+ * nrOfParts dividing 2^16) is then derived exactly, without the sequences, and    *
+ * so is the partition of ResultHistogram for check points up to 2^16; for longer  *
+ * ones the values in a bin are represented by its left end.                       *
+ *                                                                                 *
+ * Every worker thread of prng.cpp counts its sequences in its own copy (emptied   *
+ * with clear), the copies are added up with addCounts after the workers finish.   *
+ *                                                                                 *
+ * The file is binary (native, i.e. little-endian, byte order): the header         *
+ * FineHistogramHeader (earlyStopped = 1 if the run was stopped by SequentialTest, *
+ * as "earlystopped" of ResultHistogram), nrOfCheckPoints check points (int64),    *
+ * nrOfRanges ranges of seeds (first, count as int64) and the counts (uint32) of   *
+ * nrOfBins bins for every check point, of the first check point first.            *
+ ***********************************************************************************/
+struct FineHistogramHeader {
+	char magic[8];          // "PRNGHST"
+	uint32_t version;
+	uint32_t test;          // TEST_ASIN or TEST_LIL
+	int32_t logLength;
+	uint32_t nrOfCheckPoints;
+	uint32_t nrOfBins;
+	uint32_t nrOfRanges;
+	int64 total;            // number of seeds of the whole run
+	double lo;
+	double hi;
+	char prngName[128];     // with its options, e.g. "BBS_p_q -loglog"
+	char seedSource[256];   // path to seeds, empty for the default ones
+	uint32_t earlyStopped;
+
+	static const uint32_t currentVersion = 3;
+};
+
+class FineHistogram {
+	friend class ResultHistogram;
+
+	public:
+		static const int nrOfBins = 1 << 16;
+
+		FineHistogram(const char* path);
+
+		FineHistogram(TestType type, const SeqAnalyzer& analyzer, int logLength, const std::string& prngName);
+
+		static bool isFineHistogram(const char* path);
+
+		void setSeeds(const std::string& seedSource, int64 first, int64 count, int64 total);
+
+		void setEarlyStopped();
+
+		void clear();
+
+		void addSequence(const SeqAnalyzer& analyzer);
+
+		void addResult(const std::vector<double>& res);
+
+		void addCounts(const FineHistogram& other);
+
+		void add(const FineHistogram& other);
+
+		void write(const char* path) const;
+
+		int64 getNrOfSeqs() const;
+
+		int64 getNrOfMissingSeeds() const;
+
+		bool isEarlyStopped() const;
+
+		std::vector<int64> rebin(int cp_ind, int nrOfParts) const;
+
+		void printRebinned(FILE* out, int nrOfParts) const;
+
+	private:
+		TestType type;
+		int logLength;
+		std::string prngName;
+		std::string seedSource;
+		int64 total;
+		double lo;
+		double hi;
+		std::vector<std::pair<int64, int64>> ranges;
+		bool earlyStopped;
+		std::vector<std::string> labels;
+		std::vector<int64> checkPoints;
+		std::vector<uint32_t> counts;                  // counts[cp_ind * nrOfBins + bin]
+
+		int getBin(double val) const;
+
+		double getBinStart(int bin) const;
+};
+
+/***********************************************************************************
+ * Sequential test of the results of a run, used to stop it as soon as the PRNG    *
+ * fails decisively (-stop alpha in prng.cpp) instead of processing all seeds.     *
+ *                                                                                 *
+ * The results are counted in a ResultHistogram, which is tested after firstLook,  *
+ * 2 * firstLook, 4 * firstLook, ... sequences. The k-th look (k = 1, 2, ...)      *
+ * spends alpha / 2^k of the level, divided equally (Bonferroni) between the check *
+ * points of printTable, so a run of a good PRNG is stopped with probability at    *
+ * most alpha, however long it is and however often it is tested.                 *
+ *                                                                                 *
+ * The null hypothesis is not the asymptotic (arcsine, normal) law of printTable,  *
+ * which short walks do not follow closely enough for thousands of sequences, but  *
+ * the distribution of the statistic of a walk of exactly the length of the check  *
+ * point (ResultHistogram::getExactMeasure). A check point of m sequences rejects  *
+ * it at level a if both                                                           *
+ *   - the p-value of the chi-square test (p-val of printTable) is below a,        *
+ *   - tv exceeds sqrt(K / m) / 2 + sqrt(log(1 / a) / (2 m)) for K intervals,      *
+ *     which tv of m sequences of the ideal measure exceeds with probability at    *
+ *     most a (its mean is at most sqrt(K / m) / 2 and a single sequence changes   *
+ *     it by at most 1 / m, McDiarmid), so the decision does not depend on the     *
+ *     chi-square approximation, poor for intervals with small expected counts.    *
+ ***********************************************************************************/
+class SequentialTest {
+	public:
+		static const int64 firstLook = 100;
+
+		SequentialTest(TestType type, const SeqAnalyzer& analyzer, int logLength, const std::string& prngName, double alpha);
+
+		// true if the run should be stopped after this result
+		bool addResult(const std::vector<double>& res);
+
+		bool hasRejected() const;
+
+		int64 getNrOfSeqs() const;
+
+		void printSummary(FILE* out) const;
+
+	private:
+		ResultHistogram histogram;
+		std::vector<std::vector<double>> measures;   // getExactMeasure of the check points
+		double alpha;
+		int look;
+		int64 nextLook;
+		bool rejected;
+		std::string rejectedLabel;   // the check point of the decisive failure
+		double rejectedTV;
+		double rejectedPVal;
+		double rejectedLevel;
+
+		bool test(double level);
+};
+
+#endif
@@ -0,0 +1,377 @@
+#include "SeqAnalyzer.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+/***********************************************************************************
+ * Native counterpart of jl/modules/BitSeqModule.jl                                *
+ *                                                                                 *
+ * See SeqAnalyzer.hpp for the description of the walk state kept by the analyzer. *
+ ***********************************************************************************/
+
+/***********************************************************************************
+ * Walk over one byte (8 steps, least significant bit first) precomputed for       *
+ * every byte and every starting balance B, -8 <= B < 8, for which steps of the    *
+ * byte can be on both sides of the line. From B >= 8 all 8 steps are above the    *
+ * line, from B < -8 none of them.                                                 *
+ ***********************************************************************************/
+struct ByteSteps {
+	signed char disp[256];        // net displacement
+	unsigned char above[256][16]; // above[byte][B + 8] - steps with prevBalance > 0 || balance > 0
+
+	ByteSteps() {
+		for(int byte = 0; byte < 256; ++byte) {
+			for(int start = -8; start < 8; ++start) {
+				int balance = start;
+				int count = 0;
+				for(int b = 0; b < 8; ++b) {
+					int prevBalance = balance;
+					balance += ((byte >> b) & 1) ? 1 : -1;
+					count += (prevBalance > 0 || balance > 0) ? 1 : 0;
+				}
+				above[byte][start + 8] = count;
+				disp[byte] = balance - start;
+			}
+		}
+	}
+};
+
+static const ByteSteps& byteSteps() {
+	static const ByteSteps steps;
+	return steps;
+}
+
+/***********************************************************************************
+ *  PUBLIC METHODS                                                                 *
+ ***********************************************************************************/
+SeqAnalyzer::SeqAnalyzer(int nrOfCheckPoints, int logLength) :
+	firstLogCheckPoint(logLength - nrOfCheckPoints),
+	checkPoints(nrOfCheckPoints + 1),
+	balance_cp(nrOfCheckPoints + 1),
+	above_cp(nrOfCheckPoints + 1) {
+		// the same as makeCheckPoints in jl/Main.jl
+		for(int i = 0; i <= nrOfCheckPoints; ++i) {
+			checkPoints[i] = 1LL << (firstLogCheckPoint + i);
+		}
+		reset();
+	}
+
+void SeqAnalyzer::reset() {
+	pos = 0;
+	balance = 0;
+	aboveTheLine = 0;
+	cp_ind = 0;
+	next_cp = checkPoints[0];
+}
+
+// A word is processed a byte at a time with ByteSteps (or at once if the walk
+// stays on one side of the line), unless a check point lies inside the word.
+void SeqAnalyzer::addWord(uint64 word) {
+	if(pos + 64 > next_cp) {
+		addBits(word);
+		return;
+	}
+	if(balance >= 64 || balance <= -64) {
+		aboveTheLine += balance > 0 ? 64 : 0;
+		balance += 2 * __builtin_popcountll(word) - 64;
+	}
+	else {
+		const ByteSteps& steps = byteSteps();
+		for(int k = 0; k < 64; k += 8) {
+			int byte = (word >> k) & 0xFF;
+			if(balance >= 8) {
+				aboveTheLine += 8;
+			}
+			else if(balance >= -8) {
+				aboveTheLine += steps.above[byte][balance + 8];
+			}
+			balance += steps.disp[byte];
+		}
+	}
+	pos += 64;
+	if(pos == next_cp) {
+		recordCheckPoint();
+	}
+}
+
+// continues the sequence with the segment; no check point can lie inside the segment
+void SeqAnalyzer::addSegment(const WalkSegment& segment) {
+	if(pos + segment.getLength() > next_cp) {
+		fprintf(stderr, "SeqAnalyzer: check point %lld inside a segment [%lld, %lld)\n",
+			next_cp, pos, pos + segment.getLength());
+		exit(1);
+	}
+	aboveTheLine += segment.countAbove(balance);
+	balance += segment.getDisplacement();
+	pos += segment.getLength();
+	if(pos == next_cp) {
+		recordCheckPoint();
+	}
+}
+
+int SeqAnalyzer::getNrOfCheckPoints() const {
+	return checkPoints.size();
+}
+
+int64 SeqAnalyzer::getCheckPoint(int cp_ind) const {
+	return checkPoints[cp_ind];
+}
+
+string SeqAnalyzer::getCheckPointLabel(int cp_ind) const {
+	return "2^" + to_string(firstLogCheckPoint + cp_ind);
+}
+
+int64 SeqAnalyzer::getBalance(int cp_ind) const {
+	return balance_cp[cp_ind];
+}
+
+int64 SeqAnalyzer::getAboveTheLine(int cp_ind) const {
+	return above_cp[cp_ind];
+}
+
+int64 SeqAnalyzer::getOnes(int cp_ind) const {
+	return (checkPoints[cp_ind] + balance_cp[cp_ind]) / 2;
+}
+
+// fraction of the time "above the line" - countFracs in BitSeqModule.jl
+double SeqAnalyzer::getFrac(int cp_ind) const {
+	return static_cast<double>(above_cp[cp_ind]) / checkPoints[cp_ind];
+}
+
+// S_lil = S_star / sqrt(2 log log n), S_star = (2*ones - n) / sqrt(n) - S_lil in BitSeqModule.jl
+double SeqAnalyzer::getSlil(int cp_ind) const {
+	double n = static_cast<double>(checkPoints[cp_ind]);
+	double s_star = (2*getOnes(cp_ind) - checkPoints[cp_ind]) / sqrt(n);
+	return s_star / sqrt(2 * log(log(n)));
+}
+
+vector<double> SeqAnalyzer::getResults(TestType type) const {
+	vector<double> res(checkPoints.size());
+	for(size_t i = 0; i < checkPoints.size(); ++i) {
+		res[i] = (type == TEST_ASIN) ? getFrac(i) : getSlil(i);
+	}
+	return res;
+}
+
+/***********************************************************************************
+ *  PRIVATE METHODS                                                                *
+ ***********************************************************************************/
+// bit by bit, recording check points inside the word
+void SeqAnalyzer::addBits(uint64 word) {
+	for(int b = 0; b < 64; ++b) {
+		int64 prevBalance = balance;
+		balance += ((word >> b) & 1) ? 1 : -1;
+		aboveTheLine += (prevBalance > 0 || balance > 0) ? 1 : 0;
+		if(++pos == next_cp) {
+			recordCheckPoint();
+		}
+	}
+}
+
+void SeqAnalyzer::recordCheckPoint() {
+	balance_cp[cp_ind] = balance;
+	above_cp[cp_ind] = aboveTheLine;
+	++cp_ind;
+	next_cp = cp_ind < checkPoints.size() ? checkPoints[cp_ind] : LLONG_MAX;
+}
+
+/***********************************************************************************
+ *  WalkSegment                                                                    *
+ ***********************************************************************************/
+WalkSegment::WalkSegment() : length(0), balance(0), minLevel(0) {
+}
+
+// a step from prevBalance with bit b has max(prevBalance, balance) = prevBalance + b
+void WalkSegment::addWord(uint64 word) {
+	reserveLevels(balance - 64, balance + 64);
+	for(int b = 0; b < 64; ++b) {
+		int64 bit = (word >> b) & 1;
+		++levels[balance + bit - minLevel];
+		balance += 2*bit - 1;
+	}
+	length += 64;
+}
+
+int64 WalkSegment::getLength() const {
+	return length;
+}
+
+int64 WalkSegment::getDisplacement() const {
+	return balance;
+}
+
+// number of steps above the line if the segment starts at balance startBalance
+int64 WalkSegment::countAbove(int64 startBalance) const {
+	int64 res = 0;
+	for(int64 i = max<int64>(0, 1 - startBalance - minLevel); i < (int64) levels.size(); ++i) {
+		res += levels[i];
+	}
+	return res;
+}
+
+// makes levels cover [low, high], at least doubling its size when it grows
+void WalkSegment::reserveLevels(int64 low, int64 high) {
+	int64 size = levels.size();
+	int64 maxLevel = minLevel + size - 1;
+	if(low >= minLevel && high <= maxLevel) {
+		return;
+	}
+	int64 newMin = min(low, low < minLevel ? minLevel - size : minLevel);
+	int64 newMax = max(high, high > maxLevel ? maxLevel + size : maxLevel);
+	vector<int64> newLevels(newMax - newMin + 1, 0);
+	copy(levels.begin(), levels.end(), newLevels.begin() + (minLevel - newMin));
+	levels.swap(newLevels);
+	minLevel = newMin;
+}
+
+/***********************************************************************************
+ *  ResultWriter                                                                   *
+ ***********************************************************************************/
+ResultWriter::ResultWriter(const char* path, const SeqAnalyzer& analyzer, bool resume)
+	: path(path), resumed(false) {
+	string header;
+	for(int i = 0; i < analyzer.getNrOfCheckPoints(); ++i) {
+		header += (i == 0 ? "" : "; ") + analyzer.getCheckPointLabel(i);
+	}
+	lastSync = time(NULL);
+	file = resume ? fopen(path, "r+") : NULL;
+	if(file) {
+		if(!readPrevious(header)) {
+			fprintf(stderr, "%s is not a file with results of this run\n", path);
+			exit(1);
+		}
+		resumed = true;
+		return;
+	}
+	file = fopen(path, "w");
+	if(!file) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		exit(1);
+	}
+	fprintf(file, "%s\n", header.c_str());
+	fflush(file);
+}
+
+ResultWriter::~ResultWriter() {
+	fclose(file);
+}
+
+void ResultWriter::addResult(const vector<double>& res) {
+	for(size_t i = 0; i < res.size(); ++i) {
+		fprintf(file, i == 0 ? "%.17g" : "; %.17g", res[i]);
+	}
+	fprintf(file, "\n");
+	fflush(file);
+	if(time(NULL) - lastSync >= syncInterval) {
+		fsync(fileno(file));
+		lastSync = time(NULL);
+	}
+}
+
+const vector<vector<double>>& ResultWriter::getPreviousResults() const {
+	return previous;
+}
+
+// keeps only the first nrOfResults previous results, new ones are appended after them
+void ResultWriter::keepPrevious(size_t nrOfResults) {
+	if(nrOfResults >= previous.size()) {
+		return;
+	}
+	previous.resize(nrOfResults);
+	fflush(file);
+	if(ftruncate(fileno(file), ends[nrOfResults]) != 0 || fseek(file, ends[nrOfResults], SEEK_SET) != 0) {
+		perror("ResultWriter");
+		exit(1);
+	}
+}
+
+static void writeRun(const string& pathToRun, const string& run) {
+	FILE* file = fopen(pathToRun.c_str(), "w");
+	if(!file || fputs(run.c_str(), file) < 0 || fclose(file) != 0) {
+		fprintf(stderr, "Couldn't write %s\n", pathToRun.c_str());
+		exit(1);
+	}
+}
+
+// writes the description of the run to path.run, or checks that a resumed run is the one described there
+void ResultWriter::setRun(const string& description) {
+	const string pathToRun = path + ".run";
+	const string stopped = "earlystopped\n";
+	run = description;
+	if(resumed) {
+		FILE* file = fopen(pathToRun.c_str(), "r");
+		if(!file) {
+			fprintf(stderr, "Couldn't open %s, the run to resume is unknown\n", pathToRun.c_str());
+			exit(1);
+		}
+		string previousRun;
+		for(int c; (c = fgetc(file)) != EOF; ) {
+			previousRun += c;
+		}
+		fclose(file);
+		// a run stopped early can be continued
+		if(previousRun.size() >= stopped.size() && previousRun.compare(previousRun.size() - stopped.size(), stopped.size(), stopped) == 0) {
+			previousRun.resize(previousRun.size() - stopped.size());
+		}
+		if(previousRun != description) {
+			fprintf(stderr, "%s has results of another run:\n%sThis run:\n%s", path.c_str(), previousRun.c_str(), description.c_str());
+			exit(1);
+		}
+	}
+	writeRun(pathToRun, run);
+}
+
+// the run was stopped by SequentialTest
+void ResultWriter::setEarlyStopped() {
+	writeRun(path + ".run", run + "earlystopped\n");
+}
+
+// reads the results of complete lines and truncates the file after the last of them
+bool ResultWriter::readPrevious(const string& header) {
+	const size_t nrOfValues = count(header.begin(), header.end(), ';') + 1;
+	string line;
+	long end = 0;
+	bool complete = true;
+	for(int c; complete && (c = fgetc(file)) != EOF; ) {
+		if(c != '\n') {
+			line += c;
+			continue;
+		}
+		if(end == 0 && line != header) {
+			return false;
+		}
+		if(end > 0) {
+			vector<double> res;
+			const char* p = line.c_str();
+			char* next;
+			for(double v = strtod(p, &next); next != p; v = strtod(p, &next)) {
+				res.push_back(v);
+				p = next + strspn(next, "; ");
+			}
+			complete = res.size() == nrOfValues && *p == '\0';
+			if(complete) {
+				previous.push_back(res);
+			}
+		}
+		if(complete) {
+			end = ftell(file);
+			ends.push_back(end);
+		}
+		line.clear();
+	}
+	if(end == 0) {
+		return false;
+	}
+	fflush(file);
+	if(ftruncate(fileno(file), end) != 0 || fseek(file, end, SEEK_SET) != 0) {
+		perror("ResultWriter");
+		exit(1);
+	}
+	return true;
+}
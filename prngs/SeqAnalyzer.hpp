@@ -0,0 +1,160 @@
+#ifndef _SEQ_ANALYZER_H_
+#define _SEQ_ANALYZER_H_
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+typedef long long int64;
+typedef unsigned long long uint64;
+
+enum TestType { TEST_ASIN, TEST_LIL };
+
+/***********************************************************************************
+ * A contiguous part of a sequence which does not start at its beginning, e.g.     *
+ * generated by another thread after a jump of the PRNG. The balance at the start  *
+ * of the segment is not known yet, so the walk is done relative to it:            *
+ *   - displacement  - balance at the end of the segment minus the one at start    *
+ *   - levels        - levels[h] = number of steps for which                       *
+ *                     max(prevBalance, balance) = start + h                       *
+ * A step is above the line iff max(prevBalance, balance) > 0, so once the         *
+ * starting balance B is known, the segment contributes the number of steps        *
+ * with h > -B to aboveTheLine (see SeqAnalyzer::addSegment).                      *
+ ***********************************************************************************/
+class WalkSegment {
+	public:
+		WalkSegment();
+
+		void addWord(uint64 word);
+
+		int64 getLength() const;
+
+		int64 getDisplacement() const;
+
+		int64 countAbove(int64 startBalance) const;
+
+	private:
+		int64 length;       // number of bits read so far
+		int64 balance;      // relative to the start of the segment
+		int64 minLevel;     // level of levels[0]
+		std::vector<int64> levels;
+
+		void reserveLevels(int64 low, int64 high);
+};
+
+/***********************************************************************************
+ * Native counterpart of jl/modules/BitSeqModule.jl                                *
+ *                                                                                 *
+ * The analyzer consumes a sequence as 64-bit words exactly as they are written    *
+ * to stdout by GeneratorInvoker, i.e. bits are read starting from the least       *
+ * significant one (the order in which jl/Main.jl reads the stream).               *
+ *                                                                                 *
+ * For every bit it updates the state of the random walk:                          *
+ *   - balance       - (number of ones) - (number of zeros)                        *
+ *   - aboveTheLine  - number of steps for which prevBalance > 0 || balance > 0    *
+ *   - ones          - number of ones (ones = (position + balance) / 2)            *
+ * and records this state at the check points 2^(loglen-k), ..., 2^loglen          *
+ * (the same as makeCheckPoints in jl/Main.jl), from which the values of           *
+ * countFracs (ASIN) and calcSlilVal (LIL) are calculated.                         *
+ *                                                                                 *
+ * The sequence can also be continued with WalkSegments (addSegment), as long as   *
+ * every check point after the current position is at a boundary of a segment.    *
+ ***********************************************************************************/
+class SeqAnalyzer {
+	public:
+		SeqAnalyzer(int nrOfCheckPoints, int logLength);
+
+		void reset();
+
+		void addWord(uint64 word);
+
+		void addSegment(const WalkSegment& segment);
+
+		int getNrOfCheckPoints() const;
+
+		int64 getCheckPoint(int cp_ind) const;
+
+		std::string getCheckPointLabel(int cp_ind) const;
+
+		int64 getBalance(int cp_ind) const;
+
+		int64 getAboveTheLine(int cp_ind) const;
+
+		int64 getOnes(int cp_ind) const;
+
+		double getFrac(int cp_ind) const;
+
+		double getSlil(int cp_ind) const;
+
+		std::vector<double> getResults(TestType type) const;
+
+	private:
+		int firstLogCheckPoint;
+		std::vector<int64> checkPoints;
+		std::vector<int64> balance_cp; // balance recorded at each check point
+		std::vector<int64> above_cp;   // aboveTheLine recorded at each check point
+
+		int64 pos;          // number of bits read so far
+		int64 balance;
+		int64 aboveTheLine;
+		size_t cp_ind;      // index of the next check point
+		int64 next_cp;      // position of the next check point
+
+		void addBits(uint64 word);
+
+		void recordCheckPoint();
+};
+
+/***********************************************************************************
+ * Writes values of the statistic for consecutive sequences into a text file of    *
+ * the same format as TestInvoker (jl/modules/TestInvokerModule.jl) does, i.e.     *
+ * a header with check point labels followed by one line per sequence, values      *
+ * separated with "; ". Such a file can be processed by jl/modules/ResultReader.jl *
+ *                                                                                 *
+ * Every line is flushed (and the file is synced with the disk at least every      *
+ * syncInterval seconds), so the file records the progress of a run. Opened with   *
+ * resume, the results already in the file are kept (getPreviousResults) and new   *
+ * ones are appended; a partially written last line is discarded.                  *
+ * keepPrevious drops the last ones, e.g. to continue both tests of a run with     *
+ * -asin and -lil after the same sequence.                                         *
+ *                                                                                 *
+ * The run the results belong to (PRNG, seeds, range of seeds, length) is          *
+ * described in the file path.run (setRun); a run is resumed only if it is the     *
+ * same one. A run stopped by SequentialTest is marked there with "earlystopped".  *
+ ***********************************************************************************/
+class ResultWriter {
+	public:
+		static const int syncInterval = 60;
+
+		ResultWriter(const char* path, const SeqAnalyzer& analyzer, bool resume = false);
+
+		ResultWriter(const ResultWriter&) = delete;
+
+		~ResultWriter();
+
+		ResultWriter& operator=(const ResultWriter&) = delete;
+
+		void addResult(const std::vector<double>& res);
+
+		const std::vector<std::vector<double>>& getPreviousResults() const;
+
+		void keepPrevious(size_t nrOfResults);
+
+		void setRun(const std::string& description);
+
+		void setEarlyStopped();
+
+	private:
+		std::string path;
+		bool resumed;
+		std::string run;   // description of setRun
+		FILE* file;
+		time_t lastSync;
+		std::vector<std::vector<double>> previous;
+		std::vector<long> ends;    // file offsets after the header and after each previous result
+
+		bool readPrevious(const std::string& header);
+};
+
+#endif
@@ -0,0 +1,121 @@
+#include "SeqContainer.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static int64 roundUpToPage(int64 bytes) {
+	const int64 page = SeqContainerHeader::pageSize;
+	return (bytes + page - 1) / page * page;
+}
+
+/***********************************************************************************
+ *  SeqContainerWriter                                                             *
+ ***********************************************************************************/
+SeqContainerWriter::SeqContainerWriter(const char* path, const char* prngName, const char* seedSource,
+                                       int64 skip, int64 nrOfStrings, int64 length) {
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		exit(1);
+	}
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, "PRNGSEQ");
+	header.version = SeqContainerHeader::currentVersion;
+	header.bitOrder = SeqContainerHeader::lsbFirst;
+	header.nrOfStrings = nrOfStrings;
+	header.length = length;
+	header.skip = skip;
+	header.seedsOffset = roundUpToPage(sizeof(header));
+	header.dataOffset = header.seedsOffset + roundUpToPage(nrOfStrings * sizeof(uint32));
+	header.stride = roundUpToPage(length / 8);
+	strncpy(header.prngName, prngName, sizeof(header.prngName) - 1);
+	strncpy(header.seedSource, seedSource, sizeof(header.seedSource) - 1);
+
+	if(ftruncate(fd, header.dataOffset + nrOfStrings * header.stride) != 0) {
+		perror("SeqContainerWriter");
+		exit(1);
+	}
+	writeAt(0, &header, sizeof(header));
+}
+
+SeqContainerWriter::~SeqContainerWriter() {
+	close(fd);
+}
+
+void SeqContainerWriter::setSeed(int64 seq, uint32 seed) {
+	writeAt(header.seedsOffset + seq * sizeof(uint32), &seed, sizeof(seed));
+}
+
+// words wordOffset.. of sequence seq
+void SeqContainerWriter::writeWords(int64 seq, int64 wordOffset, const uint64* words, size_t nrOfWords) {
+	writeAt(header.dataOffset + seq * header.stride + wordOffset * sizeof(uint64), words, nrOfWords * sizeof(uint64));
+}
+
+void SeqContainerWriter::writeAt(int64 offset, const void* data, size_t len) {
+	const char* p = (const char*) data;
+	while(len > 0) {
+		ssize_t res = pwrite(fd, p, len, offset);
+		if(res < 0 && errno == EINTR) {
+			continue;
+		}
+		if(res < 0) {
+			perror("SeqContainerWriter");
+			exit(1);
+		}
+		p += res;
+		offset += res;
+		len -= res;
+	}
+}
+
+/***********************************************************************************
+ *  SeqContainerReader                                                             *
+ ***********************************************************************************/
+SeqContainerReader::SeqContainerReader(const char* path) {
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		exit(1);
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(header)
+			|| pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)
+			|| strcmp(header.magic, "PRNGSEQ") != 0
+			|| header.version != SeqContainerHeader::currentVersion
+			|| st.st_size < header.dataOffset + header.nrOfStrings * header.stride) {
+		fprintf(stderr, "%s is not a valid file with sequences\n", path);
+		exit(1);
+	}
+	mapSize = st.st_size;
+	void* m = mmap(NULL, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(m == MAP_FAILED) {
+		perror("SeqContainerReader");
+		exit(1);
+	}
+	map = (const char*) m;
+}
+
+SeqContainerReader::~SeqContainerReader() {
+	munmap((void*) map, mapSize);
+}
+
+const SeqContainerHeader& SeqContainerReader::getHeader() const {
+	return header;
+}
+
+uint32 SeqContainerReader::getSeed(int64 seq) const {
+	return ((const uint32*) (map + header.seedsOffset))[seq];
+}
+
+const uint64* SeqContainerReader::getSequence(int64 seq) const {
+	return (const uint64*) (map + header.dataOffset + seq * header.stride);
+}
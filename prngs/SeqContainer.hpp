@@ -0,0 +1,89 @@
+#ifndef _SEQ_CONTAINER_H_
+#define _SEQ_CONTAINER_H_
+
+#include <cstddef>
+
+typedef long long int64;
+typedef unsigned long long uint64;
+typedef unsigned int uint32;
+
+/***********************************************************************************
+ * Header of a file with generated sequences, padded to a page:                   *
+ *   - seeds of the sequences (uint32 each) start at seedsOffset                   *
+ *   - sequence i starts at dataOffset + i * stride; sequences are padded to       *
+ *     whole pages, so each of them can be memory-mapped on its own                *
+ * Words of a sequence are the 64-bit little-endian words written to stdout by     *
+ * GeneratorInvoker, bits are read starting from the least significant one.        *
+ ***********************************************************************************/
+struct SeqContainerHeader {
+	char magic[8];          // "PRNGSEQ"
+	uint32 version;
+	uint32 bitOrder;        // SeqContainerHeader::lsbFirst
+	int64 nrOfStrings;
+	int64 length;           // of a sequence, in bits
+	int64 skip;             // number of seeds skipped
+	int64 seedsOffset;
+	int64 dataOffset;
+	int64 stride;           // bytes between consecutive sequences
+	char prngName[64];
+	char seedSource[256];   // path to seeds, empty for the default ones
+
+	static const uint32 currentVersion = 1;
+	static const uint32 lsbFirst = 0;
+	static const int64 pageSize = 4096;
+};
+
+/***********************************************************************************
+ * Creates the file with its final size, so sequences (or their parts) can be      *
+ * written in any order and by many threads at once (writeWords uses pwrite and    *
+ * no shared state).                                                               *
+ ***********************************************************************************/
+class SeqContainerWriter {
+	public:
+		SeqContainerWriter(const char* path, const char* prngName, const char* seedSource,
+		                   int64 skip, int64 nrOfStrings, int64 length);
+
+		SeqContainerWriter(const SeqContainerWriter&) = delete;
+
+		~SeqContainerWriter();
+
+		SeqContainerWriter& operator=(const SeqContainerWriter&) = delete;
+
+		void setSeed(int64 seq, uint32 seed);
+
+		void writeWords(int64 seq, int64 wordOffset, const uint64* words, size_t nrOfWords);
+
+	private:
+		int fd;
+		SeqContainerHeader header;
+
+		void writeAt(int64 offset, const void* data, size_t len);
+};
+
+/***********************************************************************************
+ * Memory-maps the whole file read-only; sequences can then be processed           *
+ * concurrently, in any order.                                                     *
+ ***********************************************************************************/
+class SeqContainerReader {
+	public:
+		SeqContainerReader(const char* path);
+
+		SeqContainerReader(const SeqContainerReader&) = delete;
+
+		~SeqContainerReader();
+
+		SeqContainerReader& operator=(const SeqContainerReader&) = delete;
+
+		const SeqContainerHeader& getHeader() const;
+
+		uint32 getSeed(int64 seq) const;
+
+		const uint64* getSequence(int64 seq) const; // length / 64 words
+
+	private:
+		size_t mapSize;
+		const char* map;
+		SeqContainerHeader header;
+};
+
+#endif
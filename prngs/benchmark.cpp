@@ -0,0 +1,263 @@
+#define PRNG_NO_MAIN
+#include "prng.cpp"
+
+#include <chrono>
+
+/**********************************************************************************
+ *                                                                                *
+ *  benchmark - throughput (bits/sec) of every PRNG of prngRegistry and of the    *
+ *              stages of a run, printed as JSON:                                 *
+ *    - generate: outputs of PRNG::nextInts                                       *
+ *    - pack:     words of ChunkGenerator::nextChunk                              *
+ *    - output:   the same words written through OutputBuffer to a pipe, read     *
+ *                back by another thread (as by jl/Main.jl)                       *
+ *    - FlawedPath::generateBitSequence2 and the streaming mode, several lengths  *
+ *    - the walk of SeqAnalyzer (both ASIN and LIL) and of WalkSegment            *
+ *                                                                                *
+ *  Every stage is run nrOfReps times, the best time is reported, and once more   *
+ *  to compute the FNV-1a checksum of its 64-bit words (the output stage checks   *
+ *  the words read from the pipe, so its checksum equals the one of pack). Equal  *
+ *  checksums before and after a change show that the output is bit-identical.   *
+ *                                                                                *
+ **********************************************************************************/
+static const uint32 benchmarkSeed = 112358;
+
+// FNV-1a of 64-bit words
+struct Checksum {
+	ulong64 h = 14695981039346656037ULL;
+
+	void add(const ulong64* words, size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			h = (h ^ words[i]) * 1099511628211ULL;
+		}
+	}
+};
+
+struct Measurement {
+	double bitsPerSec;
+	ulong64 checksum;
+};
+
+static double now() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// stage(checksum) processes the bits once and returns their number, checksum is NULL in timed runs
+static Measurement measure(int nrOfReps, function<long64(Checksum*)> stage) {
+	double best = 0;
+	for (int r = 0; r < nrOfReps; ++r) {
+		double start = now();
+		long64 bits = stage(NULL);
+		double t = now() - start;
+		best = max(best, bits / max(t, 1e-9));
+	}
+	Checksum c;
+	stage(&c);
+	Measurement m = {best, c.h};
+	return m;
+}
+
+static long64 generate(shared_ptr<PRNG> prng, long64 nrOfBits, Checksum* c) {
+	const long64 nrOfOutputs = nrOfBits / prng->getNrOfBits();
+	vector<ulong64> buf(1 << 12);
+	prng->setSeedNr(0);
+	prng->setSeed(benchmarkSeed);
+	for (long64 i = 0; i < nrOfOutputs; i += buf.size()) {
+		size_t n = min<long64>(buf.size(), nrOfOutputs - i);
+		prng->nextInts(buf.data(), n);
+		if (c) {
+			c->add(buf.data(), n);
+		}
+	}
+	return nrOfOutputs * prng->getNrOfBits();
+}
+
+static volatile ulong64 sink;
+
+static long64 pack(shared_ptr<PRNG> prng, long64 nrOfBits, Checksum* c) {
+	ChunkGenerator g(prng);
+	prng->setSeedNr(0);
+	prng->setSeed(benchmarkSeed);
+	g.reset(nrOfBits);
+	ulong64 x = 0;
+	for (long64 i = 0; i < nrOfBits / 64; ++i) {
+		ulong64 word = g.nextChunk();
+		x ^= word;
+		if (c) {
+			c->add(&word, 1);
+		}
+	}
+	sink = x;
+	return nrOfBits;
+}
+
+// reads the pipe until it is closed, as the other end of a run
+static void readPipe(int fd, Checksum* c) {
+	vector<char> buf(1 << 20);
+	size_t kept = 0; // bytes of an incomplete word
+	while (true) {
+		ssize_t res = read(fd, buf.data() + kept, buf.size() - kept);
+		if (res < 0 && errno == EINTR) {
+			continue;
+		}
+		if (res <= 0) {
+			break;
+		}
+		size_t len = kept + res;
+		size_t nrOfWords = len / sizeof(ulong64);
+		if (c) {
+			c->add((const ulong64*) buf.data(), nrOfWords);
+		}
+		kept = len - nrOfWords * sizeof(ulong64);
+		memmove(buf.data(), buf.data() + nrOfWords * sizeof(ulong64), kept);
+	}
+}
+
+static long64 output(shared_ptr<PRNG> prng, long64 nrOfBits, size_t bufferSize, Checksum* c) {
+	int fds[2];
+	if (pipe(fds) != 0) {
+		perror("benchmark");
+		exit(1);
+	}
+	thread reader(readPipe, fds[0], c);
+	{
+		OutputBuffer out(fds[1], bufferSize);
+		ChunkGenerator g(prng);
+		prng->setSeedNr(0);
+		prng->setSeed(benchmarkSeed);
+		g.reset(nrOfBits);
+		for (long64 i = 0; i < nrOfBits / 64; ) {
+			size_t n = nrOfBits / 64 - i;
+			ulong64* words = out.reserve(n);
+			for (size_t j = 0; j < n; ++j) {
+				words[j] = g.nextChunk();
+			}
+			out.commit(n);
+			i += n;
+		}
+	}
+	close(fds[1]);
+	reader.join();
+	close(fds[0]);
+	return nrOfBits;
+}
+
+static long64 flawedPath(FlawedPath& fp, long64 path_n, bool streaming, Checksum* c) {
+	ulong64 x = 0;
+	if (streaming) {
+		fp.startStream(path_n, benchmarkSeed);
+		while (!fp.streamEnded()) {
+			ulong64 word = fp.nextStreamWord();
+			x ^= word;
+			if (c) {
+				c->add(&word, 1);
+			}
+		}
+	}
+	else {
+		fp.generateBitSequence2(path_n, benchmarkSeed);
+		for (long64 pos = 0; pos < fp.pathLength() && c; pos += 64) {
+			ulong64 word = fp.getPathWord(pos);
+			c->add(&word, 1);
+		}
+	}
+	sink = x;
+	return 4 * path_n;
+}
+
+// the walk of words; the checksum is of the counts (of ASIN and LIL) at the check points
+static long64 analyze(const vector<ulong64>& words, int logLength, Checksum* c) {
+	SeqAnalyzer an(logLength - 6, logLength);
+	for (size_t i = 0; i < words.size(); ++i) {
+		an.addWord(words[i]);
+	}
+	for (int i = 0; i < an.getNrOfCheckPoints() && c; ++i) {
+		ulong64 v[2] = {(ulong64) an.getAboveTheLine(i), (ulong64) an.getBalance(i)};
+		c->add(v, 2);
+	}
+	return words.size() * 64;
+}
+
+static long64 walkSegment(const vector<ulong64>& words, Checksum* c) {
+	WalkSegment walk;
+	for (size_t i = 0; i < words.size(); ++i) {
+		walk.addWord(words[i]);
+	}
+	for (int64 b = -2; b <= 2 && c; ++b) {
+		ulong64 v = walk.countAbove(b);
+		c->add(&v, 1);
+	}
+	return words.size() * 64;
+}
+
+static void printMeasurement(const char* stage, const Measurement& m, const char* sep) {
+	printf("\"%s\": {\"bitsPerSec\": %.6g, \"checksum\": \"%016llx\"}%s", stage, m.bitsPerSec, m.checksum, sep);
+}
+
+int main(int argc, char** argv) {
+	initPow();
+
+	int logLength = 24;
+	int nrOfReps = 3;
+	size_t outputBufferKB = 4096;
+	vector<char*> names;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-len") == 0 && i + 1 < argc) {
+			logLength = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-reps") == 0 && i + 1 < argc) {
+			nrOfReps = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-buf") == 0 && i + 1 < argc) {
+			outputBufferKB = atoi(argv[++i]);
+		}
+		else {
+			names.push_back(argv[i]);
+		}
+	}
+	if (logLength < 12 || logLength > 40 || nrOfReps <= 0 || outputBufferKB == 0) {
+		printf("Usage: %s [-len log2 of bits per stage >= 12] [-reps nrOfReps] [-buf output buffer size in KB] [prng name...]\n", argv[0]);
+		exit(1);
+	}
+	if (names.empty()) {
+		for (const PRNGEntry& entry : prngRegistry) {
+			names.push_back((char*) entry.name);
+		}
+	}
+	const long64 nrOfBits = 1LL << logLength;
+
+	printf("{\n\"log2Bits\": %d,\n\"reps\": %d,\n\"seed\": %u,\n\"prngs\": [\n", logLength, nrOfReps, benchmarkSeed);
+	for (size_t k = 0; k < names.size(); ++k) {
+		shared_ptr<PRNG> prng = getPRNG(names[k], logLength);
+		if (!prng) {
+			fprintf(stderr, "Unknown prng: %s\n", names[k]);
+			exit(1);
+		}
+		fprintf(stderr, "benchmark: %s\n", names[k]);
+		printf("  {\"name\": \"%s\", \"nrOfBits\": %u, ", names[k], prng->getNrOfBits());
+		printMeasurement("generate", measure(nrOfReps, [&](Checksum* c) { return generate(prng, nrOfBits, c); }), ", ");
+		printMeasurement("pack", measure(nrOfReps, [&](Checksum* c) { return pack(prng, nrOfBits, c); }), ", ");
+		printMeasurement("output", measure(nrOfReps, [&](Checksum* c) { return output(prng, nrOfBits, outputBufferKB * 1024, c); }), "");
+		printf("}%s\n", k + 1 < names.size() ? "," : "");
+	}
+	printf("],\n\"flawedPath\": [\n");
+	FlawedPath fp;
+	for (int log = 12; log <= logLength; log += 4) {
+		const long64 path_n = 1LL << (log - 2);
+		fprintf(stderr, "benchmark: FlawedPath 2^%d\n", log);
+		printf("  {\"log2Bits\": %d, ", log);
+		printMeasurement("generateBitSequence2", measure(nrOfReps, [&](Checksum* c) { return flawedPath(fp, path_n, false, c); }), ", ");
+		printMeasurement("stream", measure(nrOfReps, [&](Checksum* c) { return flawedPath(fp, path_n, true, c); }), "");
+		printf("}%s\n", log + 4 <= logLength ? "," : "");
+	}
+	printf("],\n\"kernels\": {");
+	fprintf(stderr, "benchmark: kernels\n");
+	vector<ulong64> words(nrOfBits / 64);
+	Mersenne mt;
+	mt.setSeed(benchmarkSeed);
+	mt.nextInts(words.data(), words.size());
+	printMeasurement("seqAnalyzer", measure(nrOfReps, [&](Checksum* c) { return analyze(words, logLength, c); }), ", ");
+	printMeasurement("walkSegment", measure(nrOfReps, [&](Checksum* c) { return walkSegment(words, c); }), "");
+	printf("}\n}\n");
+	return 0;
+}
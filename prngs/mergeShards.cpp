@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ResultHistogram.hpp"
+
+/**********************************************************************************
+ *                                                                                *
+ *  mergeShards - merges histogram files (-hist of prng.cpp) of disjoint ranges   *
+ *                of seeds of a single run, e.g. of its shards (-shard k/N)       *
+ *                computed on different machines, and prints the table of         *
+ *                distances (tv, sep1, sep2, p-val) of jl/modules/ResultReader.jl *
+ *                                                                                *
+ *                Fine histogram files (-fhist) are merged the same way; with     *
+ *                -rebin nrOfParts the counts in nrOfParts equal intervals are    *
+ *                printed instead of the table.                                   *
+ *                                                                                *
+ **********************************************************************************/
+template <class Histogram>
+static Histogram merge(char** paths, int nrOfPaths)
+{
+	Histogram merged(paths[0]);
+	for (int i = 1; i < nrOfPaths; ++i) {
+		merged.add(Histogram(paths[i]));
+	}
+	if (merged.getNrOfMissingSeeds() > 0) {
+		fprintf(stderr, "mergeShards: %lld seeds of the run are not in the given files\n", merged.getNrOfMissingSeeds());
+	}
+	if (merged.getNrOfSeqs() == 0) {
+		fprintf(stderr, "mergeShards: no sequences\n");
+		exit(1);
+	}
+	if (merged.isEarlyStopped()) {
+		fprintf(stderr, "mergeShards: the run was stopped early by its sequential test (-stop)\n");
+	}
+	return merged;
+}
+
+int main(int argc, char** argv)
+{
+	const char* pathToMerged = NULL;
+	int nrOfParts = 0;
+	int first = 1;
+	while (first + 1 < argc && argv[first][0] == '-') {
+		if (strcmp(argv[first], "-o") == 0) {
+			pathToMerged = argv[first + 1];
+		}
+		else if (strcmp(argv[first], "-rebin") == 0) {
+			nrOfParts = atoi(argv[first + 1]);
+		}
+		else {
+			break;
+		}
+		first += 2;
+	}
+	if (first >= argc) {
+		printf("Usage: %s [-o pathToMergedHistogram] [-rebin nrOfParts] pathToHistogram...\n", argv[0]);
+		exit(1);
+	}
+
+	if (FineHistogram::isFineHistogram(argv[first])) {
+		FineHistogram merged = merge<FineHistogram>(argv + first, argc - first);
+		if (pathToMerged) {
+			merged.write(pathToMerged);
+		}
+		if (nrOfParts > 0) {
+			merged.printRebinned(stdout, nrOfParts);
+		}
+		else {
+			ResultHistogram(merged).printTable(stdout);
+		}
+		return 0;
+	}
+	if (nrOfParts > 0) {
+		fprintf(stderr, "mergeShards: -rebin requires fine histograms (-fhist)\n");
+		exit(1);
+	}
+	ResultHistogram merged = merge<ResultHistogram>(argv + first, argc - first);
+	if (pathToMerged) {
+		merged.write(pathToMerged);
+	}
+	merged.printTable(stdout);
+	return 0;
+}
@@ -7,9 +7,29 @@
 #include <iterator>
 #include <numeric>
 #include <iostream>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <pthread.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 
 #include <cln/cln.h>
 #include "FlawedPath.hpp"
+#include "SeqAnalyzer.hpp"
+#include "SeqContainer.hpp"
+#include "ResultHistogram.hpp"
 
 typedef long long long64;
 typedef unsigned long long ulong64;
@@ -69,12 +89,100 @@ ulong64 powerMod(ulong64 base, ulong64 exp, ulong64 mod)
 	return res;
 }
 
+/*
+ * A, B such that k steps of x -> (a*x + b) % M are x -> (A*x + B) % M,
+ * i.e. k-th power of the affine map by squaring (M <= 2^32)
+ */
+void affinePower(ulong64 a, ulong64 b, ulong64 M, ulong64 k, ulong64& A, ulong64& B)
+{
+	A = 1;
+	B = 0;
+	a %= M;
+	b %= M;
+	
+	while(k)
+	{
+		if(k & 1) // (A, B) = (a, b) after (A, B)
+		{
+			A = (a * A) % M;
+			B = (a * B + b) % M;
+		}
+		
+		b = (a * b + b) % M; // (a, b) = (a, b) after (a, b)
+		a = (a * a) % M;
+		k >>= 1;
+	}
+}
+
+/*************************************************************
+ *                                                           *
+ *  LanePRNG - nrOfLanes independent instances of a PRNG     *
+ *  (one seed per lane) advanced together, so that the       *
+ *  recurrences for different seeds are computed in vector   *
+ *  lanes instead of waiting on each other step by step.     *
+ *                                                           *
+ *************************************************************/
+class LanePRNG
+{
+public:
+    static const int nrOfLanes = 8;
+    
+    virtual ~LanePRNG()
+    {
+    }
+    
+    virtual void setSeeds(const uint32* seeds) = 0;
+    
+    // out[i * nrOfLanes + lane] = i-th next output of the lane, i < n
+    virtual void nextInts(ulong64* out, size_t n) = 0;
+};
+
+// GCC vector extensions - compiled to AVX-512, AVX2 or SSE2 instructions
+// (or to scalar code), depending on the target (e.g. -march=native)
+typedef ulong64 vec_u64 __attribute__((vector_size(8 * LanePRNG::nrOfLanes)));
+typedef uint32 vec_u32 __attribute__((vector_size(4 * LanePRNG::nrOfLanes)));
+typedef long64 vec_i64 __attribute__((vector_size(8 * LanePRNG::nrOfLanes)));
+
 class PRNG
 {
 public:
     virtual void setSeed(uint32 seed) = 0;
     virtual ulong64 nextInt() = 0;
     virtual uint32 getNrOfBits() = 0;
+    
+    // Fills buf with the next n outputs, i.e. the same as n calls of nextInt().
+    // PRNGs override it with a loop without a virtual call per output.
+    virtual void nextInts(ulong64* buf, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            buf[i] = nextInt();
+    }
+    
+    // Number of seeds set so far. Only PRNGs whose output depends on the
+    // position of the seed (e.g. every 100th sequence is flawed) use it.
+    virtual void setSeedNr(long64)
+    {
+    }
+    
+    // true if jump() takes O(log nrOfOutputs) time, e.g. for LCGs
+    virtual bool canJump()
+    {
+        return false;
+    }
+    
+    // Skips the next nrOfOutputs outputs, i.e. the same as nrOfOutputs calls of nextInt().
+    virtual void jump(ulong64 nrOfOutputs)
+    {
+        for (ulong64 i = 0; i < nrOfOutputs; ++i)
+            nextInt();
+    }
+    
+    // A new multi-lane engine producing the same outputs as this PRNG
+    // for nrOfLanes seeds at once, or null if there is none.
+    virtual shared_ptr<LanePRNG> newLanes()
+    {
+        return shared_ptr<LanePRNG>();
+    }
 };
 
 class OneByte : public PRNG
@@ -91,11 +199,33 @@ public:
         prng->setSeed(seed);
     }
     
+    void setSeedNr(long64 seedNr)
+    {
+        prng->setSeedNr(seedNr);
+    }
+    
+    bool canJump()
+    {
+        return prng->canJump();
+    }
+    
+    void jump(ulong64 nrOfOutputs)
+    {
+        prng->jump(nrOfOutputs);
+    }
+    
     ulong64 nextInt()
     {
         return getByte(prng->nextInt());
     }
     
+    void nextInts(ulong64* buf, size_t n)
+    {
+        prng->nextInts(buf, n);
+        for (size_t i = 0; i < n; ++i)
+            buf[i] = getByte(buf[i]);
+    }
+    
     uint32 getNrOfBits()
     {
         return 8u;
@@ -114,30 +244,98 @@ private:
 
 /*************************************************************
  *                                                           *
- *  A wrapping class for a PRNG which allows outputting      *
- *  only some selected bits from numbers actually produced   * 
- *  by that PRNG.                                            *
+ *  Bits leastSig..leastSig + nrOfBits - 1 of the outputs    *
+ *  of nrOfLanes engines.                                    *
  *                                                           *
  *************************************************************/
-class SomeBits : public PRNG
+class SomeBitsLanes : public LanePRNG
 {
 public:
-    SomeBits(shared_ptr<PRNG> prng_, uint32 mostSig_, uint32 leastSig_)
-        : prng(prng_)
-        , mostSig(mostSig_)
+    SomeBitsLanes(shared_ptr<LanePRNG> lanes_, uint32 leastSig_, uint32 nrOfBits_)
+        : lanes(lanes_)
         , leastSig(leastSig_)
-        , nrOfBits(mostSig_ + 1 - leastSig_)
+        , nrOfBits(nrOfBits_)
+    {
+    }
+    
+    void setSeeds(const uint32* seeds)
     {
+        lanes->setSeeds(seeds);
     }
     
+    void nextInts(ulong64* out, size_t n)
+    {
+        lanes->nextInts(out, n);
+        const ulong64 mask = pow2m1[nrOfBits];
+        for (size_t i = 0; i < n * nrOfLanes; ++i)
+            out[i] = (out[i] >> leastSig) & mask;
+    }
+    
+private:
+    const shared_ptr<LanePRNG> lanes;
+    const uint32 leastSig;
+    const uint32 nrOfBits;
+};
+
+/**********************************************************************************
+ *                                                                                *
+ *  Composed - a PRNG outputting bits leastSig..leastSig + nrOfBits - 1 of the    *
+ *             outputs of an Engine, e.g. bits 23..30 of the LCG of NewMinstd3.   *
+ *                                                                                *
+ *  The engine and the selected bits are template parameters, so the step of the  *
+ *  engine and the selection of bits are inlined into a single loop in nextInts,  *
+ *  without virtual calls between them. An Engine provides:                       *
+ *    - setSeed(seed), next() - the next output,                                  *
+ *    - canJump, jump(nrOfOutputs) if canJump,                                    *
+ *    - newLanes(nrOfBits) - a LanePRNG of outputs masked to nrOfBits bits or     *
+ *      null.                                                                     *
+ *  Generators are composed in prngRegistry (see getPRNG).                        *
+ *                                                                                *
+ **********************************************************************************/
+template <class Engine, uint32 leastSig, uint32 nrOfBits>
+class Composed : public PRNG
+{
+public:
+    static_assert(leastSig + nrOfBits < 64, "Composed: at most 63 bits");
+    
     void setSeed(uint32 seed)
     {
-        prng->setSeed(seed);
+        engine.setSeed(seed);
     }
     
     ulong64 nextInt()
     {
-        return getBits(prng->nextInt());
+        return select(engine.next());
+    }
+    
+    void nextInts(ulong64* buf, size_t n)
+    {
+        Engine e = engine; // the state is kept in registers
+        for (size_t i = 0; i < n; ++i)
+            buf[i] = select(e.next());
+        engine = e;
+    }
+    
+    bool canJump()
+    {
+        return Engine::canJump;
+    }
+    
+    void jump(ulong64 nrOfOutputs)
+    {
+        if constexpr (Engine::canJump)
+            engine.jump(nrOfOutputs);
+        else
+            for (ulong64 i = 0; i < nrOfOutputs; ++i)
+                engine.next();
+    }
+    
+    shared_ptr<LanePRNG> newLanes()
+    {
+        shared_ptr<LanePRNG> lanes = Engine::newLanes(leastSig + nrOfBits);
+        if (!lanes || leastSig == 0)
+            return lanes;
+        return shared_ptr<LanePRNG>(new SomeBitsLanes(lanes, leastSig, nrOfBits));
     }
     
     uint32 getNrOfBits()
@@ -146,76 +344,232 @@ public:
     }
     
 private:
-    const shared_ptr<PRNG> prng;
-    const uint32 mostSig;
-    const uint32 leastSig;
-    const uint32 nrOfBits;
+    Engine engine;
     
-    ulong64 getBits(ulong64 n)
+    static ulong64 select(ulong64 x)
     {
-        n = n >> leastSig;
-        return n & pow2m1[nrOfBits];
+        return (x >> leastSig) & ((1ULL << nrOfBits) - 1);
     }
 };
 
-shared_ptr<PRNG> getShifted(shared_ptr<PRNG> prng, uint32 shift)
+/*
+ * LCG for nrOfLanes seeds, with the same reductions as LCGEngine::next.
+ */
+class LCGLanes : public LanePRNG
 {
-    uint32 mg = prng->getNrOfBits() - 1;
-    uint32 lg = shift;
-    return shared_ptr<PRNG>(new SomeBits(prng, mg, lg));
-}
+public:
+    LCGLanes(ulong64 M_, ulong64 a_, ulong64 b_, uint32 nrOfBits_)
+        : M(M_)
+        , a(a_)
+        , b(b_)
+        , nrOfBits(nrOfBits_)
+    {
+    }
+    
+    void setSeeds(const uint32* seeds)
+    {
+        for (int l = 0; l < nrOfLanes; ++l)
+            s[l] = seeds[l];
+    }
+    
+    void nextInts(ulong64* out, size_t n)
+    {
+        vec_u64 x = s;
+        const ulong64 mask = pow2m1[nrOfBits];
+        if ((M & (M - 1)) == 0)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                x = (a * x + b) & (M - 1);
+                store(out + i * nrOfLanes, x & mask);
+            }
+        }
+        else if (M == pow2m1[31] && a < pow2[31] && b < pow2[31])
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                x = a * x + b;
+                x = (x & pow2m1[31]) + (x >> 31);
+                x -= (vec_u64) (x >= M) & M;
+                store(out + i * nrOfLanes, x & mask);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                x = (a * x + b) % M;
+                store(out + i * nrOfLanes, x & mask);
+            }
+        }
+        s = x;
+    }
+    
+private:
+    const ulong64 M;
+    const ulong64 a, b;
+    const uint32 nrOfBits;
+    vec_u64 s;
+    
+    static void store(ulong64* out, vec_u64 x)
+    {
+        memcpy(out, &x, sizeof(x));
+    }
+};
 
 /***********************************************
  *                                             *
  *  Linear congruential generator - LCG        *
  *                                             *
  ***********************************************/
-class LCG : public PRNG
+template <ulong64 M, ulong64 a, ulong64 b>
+class LCGEngine
 {
 public:
-    const ulong64 M;
-    const ulong64 a, b;
-    const uint32 nrOfBits;
+    static const bool canJump = M <= (1ULL << 32);
     
-    LCG(ulong64 M_, ulong64 a_, ulong64 b_, const uint32 nrOfBits_)
-        : M(M_)
-        , a(a_)
-        , b(b_)
-        , nrOfBits(nrOfBits_)
+    void setSeed(uint32 seed_)
     {
+        seed = seed_;
     }
     
-    void setSeed(uint32 seed)
+    // Moduli used in getPRNG are 2^31 and 2^31 - 1, for them the
+    // division is replaced by a mask and a Mersenne prime reduction.
+    ulong64 next()
     {
-        this->seed = seed;
+        if constexpr ((M & (M - 1)) == 0)
+        {
+            seed = (a * seed + b) & (M - 1);
+        }
+        else if constexpr (M == (1ULL << 31) - 1 && a < (1ULL << 31) && b < (1ULL << 31))
+        {
+            ulong64 s = a * seed + b;  // < 2^62
+            s = (s & M) + (s >> 31);   // s mod (2^31 - 1) up to one subtraction
+            seed = s >= M ? s - M : s;
+        }
+        else
+        {
+            seed = (a * seed + b) % M;
+        }
+        return seed;
     }
     
-    ulong64 nextInt()
+    // the seed may be >= M before the first step, (a*seed + b) % M reduces it
+    void jump(ulong64 nrOfOutputs)
     {
-        seed = (a * seed + b) % M;
-        return seed & pow2m1[nrOfBits];
+        if (nrOfOutputs == 0)
+            return;
+        ulong64 A, B;
+        affinePower(a, b, M, nrOfOutputs, A, B);
+        seed = (A * (seed % M) + B) % M;
     }
     
-    uint32 getNrOfBits()
+    static shared_ptr<LanePRNG> newLanes(uint32 nrOfBits)
     {
-        return nrOfBits;
+        return shared_ptr<LanePRNG>(new LCGLanes(M, a, b, nrOfBits));
     }
     
 private:
     ulong64 seed = 1;
 };
 
+/*
+ * 32-bit LCG x = a*x + c (mod 2^32) returning bits 16..30 - LCG32Engine - for nrOfLanes seeds.
+ */
+class LCG32Lanes : public LanePRNG
+{
+public:
+    LCG32Lanes(uint32 a_, uint32 c_)
+        : a(a_)
+        , c(c_)
+    {
+    }
+    
+    void setSeeds(const uint32* seeds)
+    {
+        for (int l = 0; l < nrOfLanes; ++l)
+            s[l] = seeds[l];
+    }
+    
+    void nextInts(ulong64* out, size_t n)
+    {
+        vec_u32 x = s;
+        for (size_t i = 0; i < n; ++i)
+        {
+            x = x * a + c;
+            vec_u64 r = __builtin_convertvector((x >> 16) & 0x7FFF, vec_u64);
+            memcpy(out + i * nrOfLanes, &r, sizeof(r));
+        }
+        s = x;
+    }
+    
+private:
+    const uint32 a, c;
+    vec_u32 s;
+};
+
+/*******************************************************************************
+ *                                                                             *
+ *  LCG32Engine - 32-bit LCG x = a*x + c (mod 2^32) returning bits 16..30,     *
+ *                the core of the Borland C++ and the Microsoft Visual C++     *
+ *                rand() functions (BorlandEngine, VisualEngine)               *
+ *                                                                             *
+ *******************************************************************************/
+template <uint32 a, uint32 c, uint32 initialSeed>
+class LCG32Engine
+{
+public:
+    static const bool canJump = true;
+    
+    void setSeed(uint32 seed)
+    {
+        myseed = seed;
+    }
+    
+    ulong64 next()
+    {
+        myseed = myseed * a + c;
+        return static_cast<ulong64>( (myseed >> 16) & 0x7FFF ); // 0x7FFF = 2^15 - 1 = 32 767 - 15 MSBs
+    }
+    
+    void jump(ulong64 nrOfOutputs)
+    {
+        ulong64 A, B;
+        affinePower(a, c, 1ULL << 32, nrOfOutputs, A, B);
+        myseed = static_cast<uint32>(A * myseed + B);
+    }
+    
+    static shared_ptr<LanePRNG> newLanes(uint32 nrOfBits)
+    {
+        shared_ptr<LanePRNG> lanes(new LCG32Lanes(a, c));
+        if (nrOfBits >= 15)
+            return lanes;
+        return shared_ptr<LanePRNG>(new SomeBitsLanes(lanes, 0, nrOfBits));
+    }
+    
+private:
+    uint32 myseed = initialSeed;
+};
+
+// 0x015A4E35 = 22 695 477
+typedef LCG32Engine<0x015A4E35u, 1u, 0x015A4E36u> BorlandEngine;
+// 0x343FDu  =   214 013
+// 0x269EC3u = 2 531 011
+typedef LCG32Engine<0x343FDu, 0x269EC3u, 1u> VisualEngine;
+
 /***************************************************
  *                                                 *
  *  Combined Multiple Recursive Generator - CMRG   *
  *                                                 *
  ***************************************************/
-class CMRG : public PRNG
+class CMRGEngine
 {
 public:
-    CMRG()
+    static const bool canJump = false;
+    
+    CMRGEngine()
     {
-        reset();
+        setSeed(1);
     }
     
     void setSeed(uint32 seed)
@@ -229,7 +583,7 @@ public:
         n = 0;
     }
     
-    ulong64 nextInt()
+    ulong64 next()
     {
         long64 nextx = xa *  x[(n+1)%3]  -  xb * x[n];
         long64 nexty = ya *  y[(n+2)%3]  -  yb * y[n];
@@ -241,28 +595,27 @@ public:
         return static_cast<ulong64>( (zm + nextx - nexty) % zm );
     }
     
-    uint32 getNrOfBits()
+    void jump(ulong64)
     {
-        return 31;
+    }
+    
+    static shared_ptr<LanePRNG> newLanes(uint32)
+    {
+        return shared_ptr<LanePRNG>();
     }
     
 private:
     long64 x[3], y[3];
-    const long64 xa = 63308;
-    const long64 xb = 183326;
-    const long64 xm = 2147483647LL;
-    const long64 ya = 86098;
-    const long64 yb = 539608;
-    const long64 ym = 2145483479LL;
-    const long64 zm = 2147483647LL;
+    static const long64 xa = 63308;
+    static const long64 xb = 183326;
+    static const long64 xm = 2147483647LL;
+    static const long64 ya = 86098;
+    static const long64 yb = 539608;
+    static const long64 ym = 2145483479LL;
+    static const long64 zm = 2147483647LL;
     int n;
     
-    void reset()
-    {
-        setSeed(1);
-    }
-    
-    long64 mymod(long64 a, long64 m)
+    static long64 mymod(long64 a, long64 m)
     {
         if (m == 0)
             return a;
@@ -275,152 +628,574 @@ private:
     }
 };
 
-/*****************************************************
- *                                                   *
- *  C_PRG - GLIBC standard library rand() function   *
- *          wrapped in the PRNG class                *
- *                                                   *
- *****************************************************/
+/**********************************************************************************
+ *                                                                                *
+ *  C_PRG - rand() of GLIBC, i.e. random() with the default TYPE_3 state,         *
+ *          computed here bit for bit instead of calling srand()/rand(), whose    *
+ *          state is global: every instance has its own state, so C_PRG runs on   *
+ *          worker threads (-t) like other PRNGs, and outputs are generated in    *
+ *          blocks of blockLen. For a seed s (1 if s = 0):                        *
+ *            r[0] = s, r[i] = 16807 * r[i-1] mod (2^31 - 1)   for i = 1..30      *
+ *            r[i] = r[i-31]                                   for i = 31..33     *
+ *            r[i] = r[i-3] + r[i-31] mod 2^32                 for i >= 34        *
+ *          and the k-th output is r[k+344] >> 1 (srandom discards 310 outputs).  *
+ *                                                                                *
+ **********************************************************************************/
 class C_PRG : public PRNG
 {
 public:
     void setSeed(uint32 seed)
     {
-        srand(seed);
-    }
-    
-    ulong64 nextInt()
-    {
-        return static_cast<ulong64>(rand());
+        uint32 init[34];
+        init[0] = seed == 0 ? 1 : seed;
+        // 16807 * word mod (2^31 - 1) without overflow (Schrage), as srandom_r
+        // does with a signed 32-bit word, i.e. negative for seeds >= 2^31
+        long64 word = (int32) init[0];
+        for (int i = 1; i < 31; ++i)
+        {
+            long64 hi = word / 127773;
+            long64 lo = word % 127773;
+            word = 16807 * lo - 2836 * hi;
+            if (word < 0)
+                word += 2147483647;
+            init[i] = (uint32) word;
+        }
+        for (int i = 31; i < 34; ++i)
+            init[i] = init[i - 31];
+        // r[3..33] are the last lag values before r[34]
+        memcpy(r, init + 3, lag * sizeof(uint32));
+        generate();
+        pos = 310;
     }
     
-    uint32 getNrOfBits()
-    {
-        return 31;
-    }
-};
-
-class BorlandPRNG : public PRNG
-{
     ulong64 nextInt()
     {
-        myseed = myseed * 0x015A4E35 + 1;
-        return static_cast<ulong64>( (myseed >> 16) & 0x7FFF );
+        if (pos == blockLen)
+            refill();
+        return r[lag + pos++] >> 1;
     }
     
-    void setSeed(uint32 seed)
+    void nextInts(ulong64* buf, size_t n)
     {
-        myseed = seed;
-        //myrand();
+        for (size_t i = 0; i < n; )
+        {
+            if (pos == blockLen)
+                refill();
+            size_t len = min<size_t>(n - i, blockLen - pos);
+            const uint32* src = r + lag + pos;
+            for (size_t j = 0; j < len; ++j)
+                buf[i + j] = src[j] >> 1;
+            pos += len;
+            i += len;
+        }
     }
     
     uint32 getNrOfBits()
     {
-        return 15;
+        return 31;
     }
     
 private:
-    uint32 myseed = 0x015A4E36;
-};
-
-
-/*******************************************************************************
- *                                                                             *
- *  VisualPRNG - custom implementation of the LCG used in the implementation   *
-                 of the Microsoft Visual C++ rand() function                   *
- *                                                                             *
- *******************************************************************************/
-class VisualPRNG : public PRNG
-{
-	
-	// 0x343FDu  =   214 013
-	// 0x269EC3u = 2 531 011
-    ulong64 nextInt()
-    {
-        myseed = myseed * 0x343FDu + 0x269EC3u;
-        return static_cast<ulong64>( (myseed >> 16) & 0x7FFF ); // 0x7FFF = 2^15 - 1 = 32 767 - 15 MSBs
-    }
+    static const int lag = 31;
+    static const size_t blockLen = 1024; // more than the 310 discarded outputs
     
-    void setSeed(uint32 seed)
+    uint32 r[lag + blockLen]; // the last lag values before the block, then the block
+    size_t pos = blockLen;    // of the next output in the block
+    
+    // the next blockLen values of the recurrence
+    void generate()
     {
-        myseed = seed;
-        //myrand();
+        for (size_t i = lag; i < lag + blockLen; ++i)
+            r[i] = r[i - 3] + r[i - lag];
     }
     
-    uint32 getNrOfBits()
+    void refill()
     {
-        return 15;
+        memcpy(r, r + blockLen, lag * sizeof(uint32));
+        generate();
+        pos = 0;
     }
-    
-private:
-    uint32 myseed = 1;
 };
 
 
 /**********************************************************************************
  *                                                                                *
- *  Mersenne - C++11 implementation of the Mersenne Twister PRNG MT19937          *
- *             implemented as the class PRNG (for convenience, to be compliant    *
- *             with common interface of all custom implementations of tested      *
- *             PRNGs).                                                            *
+ *  MT19937_64 - the 64-bit Mersenne Twister producing exactly the same outputs   *
+ *               as std::mt19937_64 (the same seeding, twist and tempering),      *
+ *               but regenerating the whole state of 312 words at once with       *
+ *               vector instructions and handing out blocks of outputs.           *
+ *                                                                                *
+ *  jump(k) skips k outputs in O(log k) polynomial operations: with the           *
+ *  characteristic polynomial phi of the twist (degree 19937), k steps of the     *
+ *  twist are g(twist) for g(x) = x^k mod phi(x) over GF(2), evaluated on the     *
+ *  state with the Horner scheme.                                                 *
  *                                                                                *
  **********************************************************************************/
-class Mersenne : public PRNG
+class MT19937_64
 {
 public:
-    void setSeed(uint32 seed)
+    static const int N = 312;
+    static const int M = 156;
+    static const int polyWords = N; // phi and polynomials mod phi fit in N words
+    
+    MT19937_64()
     {
-        eng.seed(seed);
+        seed(5489u);
     }
     
-    ulong64 nextInt()
+    void seed(ulong64 s)
     {
-//         //ulong64 r = static_cast<ulong64>(eng());
-        //fprintf(stderr, "%llu\n", r & pow2m1[63]);
-        //return r & pow2m1[63];
-        return static_cast<ulong64>(eng());
+        mt[0] = s;
+        for (int i = 1; i < N; ++i)
+            mt[i] = 6364136223846793005ULL * (mt[i - 1] ^ (mt[i - 1] >> 62)) + i;
+        idx = N;
     }
     
-    uint32 getNrOfBits()
+    ulong64 operator()()
     {
-        return 64;
+        if (idx == N)
+            twist();
+        return temper(mt[idx++]);
     }
     
-    mt19937_64 eng;
-};
-
-/**********************************************************************************
- *                                                                                *
- *  BBS -  custom implementation of the Blum-Blum-Shub PRNG. This is a quadratic  *
- *         congruential generator. Blum-Blum-Shub is an example of                *
+    void nextInts(ulong64* buf, size_t n)
+    {
+        while (n > 0)
+        {
+            if (idx == N)
+                twist();
+            size_t len = min<size_t>(n, N - idx);
+            for (size_t i = 0; i < len; ++i)
+                buf[i] = temper(mt[idx + i]);
+            idx += len;
+            buf += len;
+            n -= len;
+        }
+    }
+    
+    // the same as k calls of operator()
+    void jump(ulong64 k)
+    {
+        if (k < ulong64(N - idx))
+        {
+            idx += k;
+            return;
+        }
+        // mt is the window of the last N words of the sequence, the next twist
+        // starts from it; outputs are whole twists and r words of the next one
+        k -= N - idx;
+        ulong64 q = k / N;
+        ulong64 r = k % N;
+        if (q > 0)
+            jumpWindow(q * N);
+        idx = N;
+        if (r > 0)
+        {
+            twist();
+            idx = r;
+        }
+    }
+    
+private:
+    static const ulong64 matrixA = 0xB5026F5AA96619E9ULL;
+    static const ulong64 upperMask = 0xFFFFFFFF80000000ULL;
+    static const ulong64 lowerMask = 0x7FFFFFFFULL;
+    static const int nrOfLanes = LanePRNG::nrOfLanes;
+    
+    ulong64 mt[N];
+    int idx;
+    
+    static ulong64 temper(ulong64 y)
+    {
+        y ^= (y >> 29) & 0x5555555555555555ULL;
+        y ^= (y << 17) & 0x71D67FFFEDA60000ULL;
+        y ^= (y << 37) & 0xFFF7EEE000000000ULL;
+        y ^= (y >> 43);
+        return y;
+    }
+    
+    static ulong64 twistWord(ulong64 x, ulong64 next, ulong64 far)
+    {
+        ulong64 y = (x & upperMask) | (next & lowerMask);
+        return far ^ (y >> 1) ^ ((y & 1) ? matrixA : 0);
+    }
+    
+    // new words mt[i..i+nrOfLanes) from old mt[i..i+nrOfLanes] and mt[far..far+nrOfLanes)
+    void twistLanes(int i, int far)
+    {
+        vec_u64 x, next, res;
+        memcpy(&x, mt + i, sizeof(x));
+        memcpy(&next, mt + i + 1, sizeof(next));
+        memcpy(&res, mt + far, sizeof(res));
+        vec_u64 y = (x & upperMask) | (next & lowerMask);
+        res ^= (y >> 1) ^ (-(y & 1) & matrixA);
+        memcpy(mt + i, &res, sizeof(res));
+    }
+    
+    // Words mt[i] for i < N - M use old mt[i + M], the others new mt[i + M - N],
+    // which are at least M > nrOfLanes positions back, so both parts go in lanes.
+    void twist()
+    {
+        int i = 0;
+        for (; i + nrOfLanes <= N - M; i += nrOfLanes)
+            twistLanes(i, i + M);
+        for (; i < N - M; ++i)
+            mt[i] = twistWord(mt[i], mt[i + 1], mt[i + M]);
+        for (; i + nrOfLanes <= N - 1; i += nrOfLanes)
+            twistLanes(i, i + M - N);
+        for (; i < N - 1; ++i)
+            mt[i] = twistWord(mt[i], mt[i + 1], mt[i + M - N]);
+        mt[N - 1] = twistWord(mt[N - 1], mt[0], mt[M - 1]);
+        idx = 0;
+    }
+    
+    /*
+     * Replaces the window mt (the last N words, of which the lower bits of
+     * mt[0] do not matter) by the window k words further, i.e. computes
+     * sum of c_j * twist^j (mt) for g(x) = x^k mod phi = sum c_j x^j,
+     * with a sliding window acc (starting at acc[a]) advanced word by word.
+     */
+    void jumpWindow(ulong64 k)
+    {
+        const vector<ulong64>& phi = charPoly();
+        const int degree = 19937;
+        vector<ulong64> g = powerOfXMod(k, phi, degree);
+    
+        ulong64 acc[N] = {0};
+        int a = 0;
+        for (int j = degree - 1; j >= 0; --j)
+        {
+            acc[a] = twistWord(acc[a], acc[(a + 1) % N], acc[(a + M) % N]);
+            a = (a + 1) % N;
+            if ((g[j / 64] >> (j % 64)) & 1)
+            {
+                for (int i = 0; i < N - a; ++i)
+                    acc[a + i] ^= mt[i];
+                for (int i = N - a; i < N; ++i)
+                    acc[a + i - N] ^= mt[i];
+            }
+        }
+        for (int i = 0; i < N; ++i)
+            mt[i] = acc[(a + i) % N];
+    }
+    
+    /*
+     * x^k mod phi over GF(2) (bit j of the result is the coefficient of x^j),
+     * by squaring: reducing a square bit by bit from the top, phi shifted by
+     * the bit offset within a word is precomputed.
+     */
+    static vector<ulong64> powerOfXMod(ulong64 k, const vector<ulong64>& phi, int degree)
+    {
+        vector<vector<ulong64>> phiShifted(64, vector<ulong64>(polyWords + 1, 0));
+        for (int s = 0; s < 64; ++s)
+            for (int i = 0; i < polyWords; ++i)
+            {
+                phiShifted[s][i] |= phi[i] << s;
+                if (s > 0)
+                    phiShifted[s][i + 1] |= phi[i] >> (64 - s);
+            }
+    
+        auto reduce = [&](vector<ulong64>& p, int maxDegree)
+        {
+            for (int d = maxDegree; d >= degree; --d)
+            {
+                if (((p[d / 64] >> (d % 64)) & 1) == 0)
+                    continue;
+                int shift = d - degree;
+                const vector<ulong64>& ph = phiShifted[shift % 64];
+                for (int i = 0; i <= polyWords && shift / 64 + i < (int) p.size(); ++i)
+                    p[shift / 64 + i] ^= ph[i];
+            }
+        };
+    
+        vector<ulong64> res(2 * polyWords + 1, 0);
+        res[0] = 1;
+        int top = 63;
+        while (top > 0 && ((k >> top) & 1) == 0)
+            --top;
+        for (int b = top; b >= 0; --b)
+        {
+            // square: bit i goes to bit 2i
+            vector<ulong64> sq(2 * polyWords + 1, 0);
+            for (int i = 0; i < polyWords; ++i)
+                for (int j = 0; j < 64; ++j)
+                    if ((res[i] >> j) & 1)
+                        sq[(128 * i + 2 * j) / 64] |= 1ULL << ((2 * j) % 64);
+            if ((k >> b) & 1) // times x
+            {
+                for (int i = 2 * polyWords; i > 0; --i)
+                    sq[i] = (sq[i] << 1) | (sq[i - 1] >> 63);
+                sq[0] <<= 1;
+            }
+            reduce(sq, 2 * degree);
+            res = sq;
+        }
+        res.resize(polyWords);
+        return res;
+    }
+    
+    // characteristic polynomial of the twist, computed once (Berlekamp-Massey
+    // on the lowest bits of 2 * 19937 outputs), bit j - coefficient of x^j
+    static const vector<ulong64>& charPoly()
+    {
+        static const vector<ulong64> phi = berlekampMassey();
+        return phi;
+    }
+    
+    static vector<ulong64> berlekampMassey()
+    {
+        const int degree = 19937;
+        const int n = 2 * degree;
+        const int words = n / 64 + 2;
+    
+        // rev[n - 1 - t] = s_t, so s_t, s_(t-1), ... are consecutive bits of rev
+        vector<ulong64> rev(words, 0);
+        MT19937_64 eng;
+        for (int t = 0; t < n; ++t)
+            if (eng() & 1)
+                rev[(n - 1 - t) / 64] |= 1ULL << ((n - 1 - t) % 64);
+        auto bits = [&](int pos) // 64 bits of rev from position pos
+        {
+            ulong64 lo = rev[pos / 64] >> (pos % 64);
+            return pos % 64 ? lo | (rev[pos / 64 + 1] << (64 - pos % 64)) : lo;
+        };
+    
+        // connection polynomials C (current) and B (before the last length change)
+        vector<ulong64> C(words, 0), B(words, 0), T;
+        C[0] = B[0] = 1;
+        int L = 0, m = 1;
+        for (int t = 0; t < n; ++t)
+        {
+            // discrepancy: sum of C_i * s_(t-i), i = 0..L
+            ulong64 d = 0;
+            int start = n - 1 - t;
+            for (int i = 0; i <= L; i += 64)
+            {
+                ulong64 c = C[i / 64];
+                if (L - i < 63)
+                    c &= pow2m1[L - i + 1];
+                d ^= c & bits(start + i);
+            }
+            if (__builtin_parityll(d) == 0)
+            {
+                ++m;
+                continue;
+            }
+            T = C;
+            // C ^= B * x^m
+            int w = m / 64, s = m % 64;
+            for (int i = words - 1; i >= w; --i)
+            {
+                ulong64 v = B[i - w] << s;
+                if (s > 0 && i - w > 0)
+                    v |= B[i - w - 1] >> (64 - s);
+                C[i] ^= v;
+            }
+            if (2 * L <= t)
+            {
+                L = t + 1 - L;
+                B = T;
+                m = 1;
+            }
+            else
+            {
+                ++m;
+            }
+        }
+        if (L != degree)
+        {
+            fprintf(stderr, "MT19937_64: unexpected degree %d of the characteristic polynomial\n", L);
+            exit(1);
+        }
+    
+        // phi(x) = x^L C(1/x)
+        vector<ulong64> phi(polyWords, 0);
+        for (int i = 0; i <= L; ++i)
+            if ((C[i / 64] >> (i % 64)) & 1)
+                phi[(L - i) / 64] |= 1ULL << ((L - i) % 64);
+        return phi;
+    }
+};
+
+/**********************************************************************************
+ *                                                                                *
+ *  Mersenne - C++11 implementation of the Mersenne Twister PRNG MT19937          *
+ *             implemented as the class PRNG (for convenience, to be compliant    *
+ *             with common interface of all custom implementations of tested      *
+ *             PRNGs).                                                            *
+ *                                                                                *
+ **********************************************************************************/
+class Mersenne : public PRNG
+{
+public:
+    void setSeed(uint32 seed)
+    {
+        eng.seed(seed);
+    }
+    
+    ulong64 nextInt()
+    {
+//         //ulong64 r = static_cast<ulong64>(eng());
+        //fprintf(stderr, "%llu\n", r & pow2m1[63]);
+        //return r & pow2m1[63];
+        return static_cast<ulong64>(eng());
+    }
+    
+    void nextInts(ulong64* buf, size_t n)
+    {
+        eng.nextInts(buf, n);
+    }
+    
+    bool canJump()
+    {
+        return true;
+    }
+    
+    void jump(ulong64 nrOfOutputs)
+    {
+        eng.jump(nrOfOutputs);
+    }
+    
+    uint32 getNrOfBits()
+    {
+        return 64;
+    }
+    
+    MT19937_64 eng;
+};
+
+typedef unsigned __int128 ulong128;
+
+/**********************************************************************************
+ *                                                                                *
+ *  Montgomery128 - arithmetic modulo an odd n < 2^128 in the Montgomery form     *
+ *                  x * R mod n, R = 2^128, on two 64-bit words (CIOS), so a      *
+ *                  squaring of the BBS state needs no division and no heap.      *
+ *                                                                                *
+ **********************************************************************************/
+class Montgomery128
+{
+public:
+    Montgomery128() = default;
+    
+    Montgomery128(ulong128 n_)
+        : n(n_)
+    {
+        ulong64 n0 = static_cast<ulong64>(n);
+        ulong64 inv = n0; // Newton iteration for n0^-1 mod 2^64, each doubles the correct bits
+        for (int i = 0; i < 5; ++i)
+            inv *= 2 - n0 * inv;
+        nInv = -inv;
+        
+        r2 = 1; // R^2 mod n = 2^256 mod n
+        for (int i = 0; i < 256; ++i)
+            r2 = r2 >= n - r2 ? r2 - (n - r2) : r2 + r2;
+    }
+    
+    ulong128 toMont(ulong128 x) const
+    {
+        return mul(x % n, r2);
+    }
+    
+    ulong128 fromMont(ulong128 x) const
+    {
+        return mul(x, 1);
+    }
+    
+    // x^e mod n
+    ulong128 pow(ulong128 x, ulong128 e) const
+    {
+        ulong128 res = toMont(1);
+        ulong128 base = toMont(x);
+        while (e)
+        {
+            if (e & 1)
+                res = mul(res, base);
+            base = mul(base, base);
+            e >>= 1;
+        }
+        return fromMont(res);
+    }
+    
+    // a * b / R mod n for a, b < n
+    ulong128 mul(ulong128 a, ulong128 b) const
+    {
+        const ulong64 a0 = static_cast<ulong64>(a), a1 = static_cast<ulong64>(a >> 64);
+        const ulong64 n0 = static_cast<ulong64>(n), n1 = static_cast<ulong64>(n >> 64);
+        ulong64 t0 = 0, t1 = 0, t2 = 0;
+        for (int i = 0; i < 2; ++i)
+        {
+            const ulong64 bi = static_cast<ulong64>(b >> (64 * i));
+            // t += a * bi
+            ulong128 c = static_cast<ulong128>(a0) * bi + t0;
+            t0 = static_cast<ulong64>(c);
+            c = static_cast<ulong128>(a1) * bi + t1 + (c >> 64);
+            t1 = static_cast<ulong64>(c);
+            c = static_cast<ulong128>(t2) + (c >> 64);
+            t2 = static_cast<ulong64>(c);
+            ulong64 t3 = static_cast<ulong64>(c >> 64);
+            // t = (t + m * n) / 2^64, m such that the lowest word becomes 0
+            const ulong64 m = t0 * nInv;
+            c = static_cast<ulong128>(m) * n0 + t0;
+            c = static_cast<ulong128>(m) * n1 + t1 + (c >> 64);
+            t0 = static_cast<ulong64>(c);
+            c = static_cast<ulong128>(t2) + (c >> 64);
+            t1 = static_cast<ulong64>(c);
+            t2 = t3 + static_cast<ulong64>(c >> 64);
+        }
+        ulong128 t = (static_cast<ulong128>(t1) << 64) | t0;
+        return (t2 || t >= n) ? t - n : t; // t < 2n
+    }
+    
+private:
+    ulong128 n = 1;
+    ulong64 nInv = 0; // -n^-1 mod 2^64
+    ulong128 r2 = 0;
+};
+
+/**********************************************************************************
+ *                                                                                *
+ *  BBS -  custom implementation of the Blum-Blum-Shub PRNG. This is a quadratic  *
+ *         congruential generator. Blum-Blum-Shub is an example of                *
  *         a cryptographically secure PRNG.                                       *
  *         This class extends the generic class PRNG for PRNGs. Each invokation   *
  *         of this ghenerator produces an integer (of type unsigned long,         *
  *         typically 64-bit) constructed from bits outputted in the consecutive   *
  *         rounds of BBS.                                                         *
  *                                                                                *
- *         The internal implementation of this PRNG uses classes and methods      *
- *         for computations with large numbers from the CLN library               *
+ *         The parameters are checked with the CLN library. For n = p*q < 2^128   *
+ *         (e.g. the default parameters) the squarings are done natively with     *
+ *         Montgomery128, for larger n with CLN.                                  *
+ *                                                                                *
+ *         With multiBits every squaring outputs floor(log2(log2 n)) lowest       *
+ *         bits of the state instead of one.                                      *
+ *                                                                                *
+ *         The state after j squarings, x^(2^j) mod n, can be computed directly:  *
+ *         x^(2^j mod (p-1)) mod p and x^(2^j mod (q-1)) mod q combined with      *
+ *         the Chinese Remainder Theorem (x is coprime with n), so jump() skips   *
+ *         any number of outputs in O(log n) multiplications (natively only).     *
  *                                                                                *
  **********************************************************************************/
 class BBS64_PRNG : public PRNG
 {
 public:
 	
-	BBS64_PRNG(const unsigned long p_, const unsigned long q_) :
+	BBS64_PRNG(const unsigned long p_, const unsigned long q_, bool multiBits = false) :
 		p(p_),
 		q(q_),
 		n(p * q)
 	{		
 		check_values();
+		init(multiBits);
 	}
 	
-	BBS64_PRNG(const char* p_, const char* q_) :
+	BBS64_PRNG(const char* p_, const char* q_, bool multiBits = false) :
 		p(p_),
 		q(q_),
 		n(p * q)
 	{		
 		check_values();
+		init(multiBits);
 	}
 	
 	void setSeed(uint32 seed)
@@ -429,6 +1204,8 @@ public:
 		
 		if(cln::mod(state, p) == 0 || cln::mod(state, q) == 0)
 			throw std::invalid_argument("BBS64_PRNG :: The seed should be co-prime with n = p*q.");
+		if(native)
+			mstate = mont.toMont(toUlong128(state));
     }
 	
 	void setSeed(const char* seed) 
@@ -437,34 +1214,62 @@ public:
 		
 		if(cln::mod(state, p) == 0 || cln::mod(state, q) == 0)
 			throw std::invalid_argument("BBS64_PRNG :: The seed should be co-prime with n = p*q.");
+		if(native)
+			mstate = mont.toMont(toUlong128(cln::mod(state, n)));
     }
 	 
     ulong64 nextInt()
     {
-		cln::cl_I r = 0;
-		for(int i = 0; i < bw; ++i)
+		ulong64 r = 0;
+		for(uint32 i = 0; i < bw; i += bitsPerSquaring)
 		{
-			state = cln::mod(state * state, n);
-			r <<= 1;
-			r += (state & 1);
+			r <<= bitsPerSquaring;
+			r += nextBits();
 		}
-		return cln::cl_I_to_ulong(r);
-
+		return r;
     }
 	
+	void nextInts(ulong64* buf, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			buf[i] = BBS64_PRNG::nextInt();
+	}
+	
 	// prints a binary string consisting of bw bits generated by the generator
 	//   -> for testing and debugging purposes
 	string next_rnd_binary()
 	{
 		string s;
-		for(int i = 0; i < bw; ++i)
+		ulong64 r = nextInt();
+		for(int i = bw - 1; i >= 0; --i)
 		{
-			state = cln::mod(state * state, n);
-			s.push_back('0' + cln::cl_I_to_ulong(state & 1));
+			s.push_back('0' + ((r >> i) & 1));
 		}
 		return s;
 	}
 	
+	bool canJump()
+	{
+		return native;
+	}
+	
+	void jump(ulong64 nrOfOutputs)
+	{
+		if(!native)
+		{
+			PRNG::jump(nrOfOutputs);
+			return;
+		}
+		ulong64 squarings = nrOfOutputs * (bw / bitsPerSquaring);
+		ulong128 x = mont.fromMont(mstate);
+		ulong128 xp = montP.pow(x, powerOfTwoMod(squarings, pNat - 1));
+		ulong128 xq = montQ.pow(x, powerOfTwoMod(squarings, qNat - 1));
+		// x = xp + p * ((xq - xp) / p mod q)
+		ulong128 diff = xq >= xp % qNat ? xq - xp % qNat : xq + (qNat - xp % qNat);
+		ulong128 t = mulMod(diff, pInvModQ, qNat);
+		mstate = mont.toMont(xp + pNat * t);
+	}
+	
     uint32 getNrOfBits()
     {
         return bw;
@@ -483,12 +1288,88 @@ private:
 			throw std::invalid_argument("BBS64_PRNG :: The paramater q should be congruent to 3 (mod 4).");
 	}
 	
-	static const uint32 bw = 8*sizeof(unsigned long); // bit width
+	void init(bool multiBits)
+	{
+		uint32 length = cln::integer_length(n); // 2^(length-1) <= n < 2^length
+		native = length <= 128;
+		if(native)
+		{
+			mont = Montgomery128(toUlong128(n));
+			mstate = mont.toMont(2);
+			pNat = toUlong128(p);
+			qNat = toUlong128(q);
+			montP = Montgomery128(pNat);
+			montQ = Montgomery128(qNat);
+			pInvModQ = montQ.pow(pNat % qNat, qNat - 2);
+		}
+		// floor(log2(log2 n)) = floor(log2(length - 1)), as log2 n is in [length - 1, length)
+		bitsPerSquaring = multiBits ? 31 - __builtin_clz(length - 1) : 1;
+		bw = 64 / bitsPerSquaring * bitsPerSquaring;
+	}
+	
+	static ulong128 toUlong128(const cln::cl_I& x)
+	{
+		ulong128 lo = cln::cl_I_to_ulong(cln::ldb(x, cln::cl_byte(64, 0)));
+		ulong128 hi = cln::cl_I_to_ulong(cln::ldb(x, cln::cl_byte(64, 64)));
+		return (hi << 64) | lo;
+	}
+	
+	// a * b mod m for any m (by doubling, m may be even)
+	static ulong128 mulMod(ulong128 a, ulong128 b, ulong128 m)
+	{
+		a %= m;
+		ulong128 res = 0;
+		while(b)
+		{
+			if(b & 1)
+				res = res >= m - a ? res - (m - a) : res + a;
+			a = a >= m - a ? a - (m - a) : a + a;
+			b >>= 1;
+		}
+		return res;
+	}
+	
+	// 2^e mod m
+	static ulong128 powerOfTwoMod(ulong64 e, ulong128 m)
+	{
+		ulong128 res = 1 % m;
+		ulong128 base = 2 % m;
+		while(e)
+		{
+			if(e & 1)
+				res = mulMod(res, base, m);
+			base = mulMod(base, base, m);
+			e >>= 1;
+		}
+		return res;
+	}
+	
+	// squares the state, returns its bitsPerSquaring lowest bits
+	ulong64 nextBits()
+	{
+		if(native)
+		{
+			mstate = mont.mul(mstate, mstate);
+			return static_cast<ulong64>(mont.fromMont(mstate)) & pow2m1[bitsPerSquaring];
+		}
+		state = cln::mod(state * state, n);
+		return cln::cl_I_to_ulong(cln::ldb(state, cln::cl_byte(bitsPerSquaring, 0)));
+	}
+	
+	uint32 bw = 8*sizeof(unsigned long); // bit width
+	uint32 bitsPerSquaring = 1;
 	
 	const cln::cl_I p;
 	const cln::cl_I q;
 	const cln::cl_I n;
 	cln::cl_I state = 2;
+	
+	bool native = false;
+	Montgomery128 mont;
+	ulong128 mstate = 0;
+	ulong128 pNat = 0, qNat = 0;
+	Montgomery128 montP, montQ; // for jump()
+	ulong128 pInvModQ = 0;
     
 };
 
@@ -509,6 +1390,11 @@ public:
         eng.seed(seed);
     }
     
+    void setSeedNr(long64 seedNr_)
+    {
+        seedNr = seedNr_;
+    }
+    
     ulong64 nextInt()
     {
         if (seedNr % 100 == 0)
@@ -518,13 +1404,32 @@ public:
             return static_cast<ulong64>(eng());
     }
     
+    void nextInts(ulong64* buf, size_t n)
+    {
+        if (seedNr % 100 == 0)
+            fill(buf, buf + n, 0x9999999999999999LLu);
+        else
+            eng.nextInts(buf, n);
+    }
+    
+    bool canJump()
+    {
+        return true;
+    }
+    
+    void jump(ulong64 nrOfOutputs)
+    {
+        if (seedNr % 100 != 0)
+            eng.jump(nrOfOutputs);
+    }
+    
     uint32 getNrOfBits()
     {
         return 64;
     }
     
-    int seedNr = 0;
-    mt19937_64 eng;
+    long64 seedNr = 0;
+    MT19937_64 eng;
 };
 
 /**********************************************************************************
@@ -535,6 +1440,9 @@ public:
  *               length (by default 2^26).                                        *
  *               If all bits from a given paths were used, a new random path      *
  *               of given length is generated.                                    *
+ *               A path is generated when its first bits are needed; with         *
+ *               streaming it is sampled 64 bits at a time in bounded memory      *
+ *               (see FlawedPath), so paths of length 2^34 and more fit in RAM.   *
  *                                                                                *
  * NOTE THAT GENERATING VERY LONG PATHS MAY TAKE A LONG TIME                      *
  *                                                                                *
@@ -544,10 +1452,9 @@ class FlawedDyck : public PRNG
 public:
 	FlawedDyck() : FlawedDyck(26) {}
 	
-	FlawedDyck(uint32 path_loglen, bool do_init = true) : 
-		path_n(1 << (path_loglen < 6 ? 4 : path_loglen - 2)) {
-			if(do_init) { initializePath(); }
-		}
+	FlawedDyck(uint32 path_loglen, bool streaming = false) : 
+		path_n(1LL << (path_loglen < 6 ? 4 : path_loglen - 2)),
+		streaming(streaming) {}
 
     void setSeed(uint32 seed) {
 		// generate new path using given seed for the underlying prng
@@ -555,17 +1462,18 @@ public:
     }
     
     ulong64 nextInt() {
+		if(streaming) {
+			if(eng.streamEnded()) {
+				eng.startStream(path_n);
+			}
+			return eng.nextStreamWord();
+		}
         // generate new path if current path contains too few "fresh" bits
-		if(distance(it_path, eng.itPathEnd()) < getNrOfBits()) {
+		if(eng.pathLength() - path_pos < getNrOfBits()) {
 			initializePath();
 		}
-		auto it = it_path;
-		it_path += getNrOfBits();
-		ulong64 r = 0;
-		while(it != it_path) {
-			r <<= 1;
-			if(*(it++)) ++r; // "safer" and "cleaner" than r = 2*r+(*it)
-		}
+		ulong64 r = eng.getPathWord(path_pos); // the first bit is the most significant one
+		path_pos += getNrOfBits();
 		return r;
     }
     
@@ -575,18 +1483,23 @@ public:
    
 private:
 	long64 path_n; // length of the Dyck Path is 4n
+	bool streaming;
     
 	FlawedPath eng;
-	vector<bool>::iterator it_path;
+	long64 path_pos = 0; // position of the next "fresh" bit of the path
 	
 	void initializePath() {
 		eng.generateBitSequence2(path_n);
-		it_path = eng.itPathBegin();
+		path_pos = 0;
 	}
 	
 	void initializePath(uint32 seed) {
+		if(streaming) {
+			eng.startStream(path_n, seed);
+			return;
+		}
 		eng.generateBitSequence2(path_n, seed);
-		it_path = eng.itPathBegin();
+		path_pos = 0;
 	}
 };
 
@@ -603,11 +1516,14 @@ class FlawedDyckMT : public PRNG
 public:
 	FlawedDyckMT() : FlawedDyckMT(26, 100) {}
 	
-	FlawedDyckMT(uint32 path_loglen, uint32 step, bool do_init = true) : 
-		path_n(1 << (path_loglen < 6 ? 4 : path_loglen - 2)),
-		step(step == 0 ? 1 : step) {
-			if(do_init) { initializePath(); }
-		}
+	FlawedDyckMT(uint32 path_loglen, uint32 step, bool streaming = false) : 
+		step(step == 0 ? 1 : step),
+		path_n(1LL << (path_loglen < 6 ? 4 : path_loglen - 2)),
+		streaming(streaming) {}
+
+    void setSeedNr(long64 seedNr_) {
+        seedNr = seedNr_;
+    }
 
     void setSeed(uint32 seed) {
         if(++seedNr % step == 0) {
@@ -628,42 +1544,77 @@ public:
 		}
     }
     
+    void nextInts(ulong64* buf, size_t n) {
+        if (seedNr % step == 0) {
+            for (size_t i = 0; i < n; ++i)
+                buf[i] = nextIntFromPath();
+        }
+        else {
+            mt_eng.nextInts(buf, n);
+        }
+    }
+    
+    // only the Mersenne Twister jumps quickly, a path is skipped
+    // directly only within the current path
+    bool canJump() {
+        return true;
+    }
+    
+    void jump(ulong64 nrOfOutputs) {
+        if (seedNr % step != 0) {
+            mt_eng.jump(nrOfOutputs);
+        }
+        else if (!streaming && path_eng.pathLength() - path_pos >= (long64) (nrOfOutputs * getNrOfBits())) {
+            path_pos += nrOfOutputs * getNrOfBits();
+        }
+        else {
+            for (ulong64 i = 0; i < nrOfOutputs; ++i)
+                nextIntFromPath();
+        }
+    }
+    
     uint32 getNrOfBits() {
         return 64;
     }
    
 private:
-    int seedNr = 0;
+    long64 seedNr = 0;
 	uint32 step; 
 	long64 path_n; // length of the Dyck Path is 4n
+	bool streaming;
     
 	FlawedPath path_eng;
-	mt19937_64 mt_eng;
+	MT19937_64 mt_eng;
 
-	vector<bool>::iterator it_path;
+	long64 path_pos = 0; // position of the next "fresh" bit of the path
 	
 	void initializePath() {
 		path_eng.generateBitSequence2(path_n);
-		it_path = path_eng.itPathBegin();
+		path_pos = 0;
 	}
 
 	void initializePath(uint32 seed) {
+		if(streaming) {
+			path_eng.startStream(path_n, seed);
+			return;
+		}
 		path_eng.generateBitSequence2(path_n, seed);
-		it_path = path_eng.itPathBegin();
+		path_pos = 0;
 	}
 
 	ulong64 nextIntFromPath() {
+		if(streaming) {
+			if(path_eng.streamEnded()) {
+				path_eng.startStream(path_n);
+			}
+			return path_eng.nextStreamWord();
+		}
 		// generate new path if current path contains too few "fresh" bits
-		if(distance(it_path, path_eng.itPathEnd()) < getNrOfBits()) {
+		if(path_eng.pathLength() - path_pos < getNrOfBits()) {
 			initializePath();
 		}
-		auto it = it_path;
-		it_path += getNrOfBits();
-		ulong64 r = 0;
-		while(it != it_path) {
-			r <<= 1;
-			if(*(it++)) ++r; // "safer" and "cleaner" than r = 2*r+(*it)
-		}
+		ulong64 r = path_eng.getPathWord(path_pos); // the first bit is the most significant one
+		path_pos += getNrOfBits();
 		return r;
 	}
 	
@@ -683,6 +1634,33 @@ public:
         return s;
     }
     
+    void nextInts(ulong64* buf, size_t n)
+    {
+        ulong64 x = s;
+        for (size_t i = 0; i < n; ++i)
+        {
+            x = (65539llu * x) & pow2m1[31];
+            buf[i] = x;
+        }
+        s = x;
+    }
+    
+    bool canJump()
+    {
+        return true;
+    }
+    
+    void jump(ulong64 nrOfOutputs)
+    {
+        if (nrOfOutputs == 0)
+            return;
+        ulong64 A, B;
+        affinePower(65539llu, 0, pow2[31], nrOfOutputs, A, B);
+        s = (A * (s % pow2[31])) % pow2[31];
+    }
+    
+    shared_ptr<LanePRNG> newLanes();
+    
     uint32 getNrOfBits()
     {
         return 31;
@@ -691,298 +1669,1485 @@ public:
     ulong64 s;
 };
 
-class GeneratorInvoker
+class RandULanes : public LanePRNG
 {
 public:
-    GeneratorInvoker() = default;
-    
-    GeneratorInvoker(shared_ptr<PRNG>& prng_)
-        : prng(prng_)
+    void setSeeds(const uint32* seeds)
     {
+        for (int l = 0; l < nrOfLanes; ++l)
+            s[l] = seeds[l] + (seeds[l] % 2 == 0 ? 1 : 0);
     }
     
-    GeneratorInvoker(shared_ptr<PRNG>& prng_, long64 nrOfSeedsToSkip_)
-        : prng(prng_)
-        , nrOfSeedsToSkip(nrOfSeedsToSkip_)
+    void nextInts(ulong64* out, size_t n)
     {
+        vec_u64 x = s;
+        for (size_t i = 0; i < n; ++i)
+        {
+            x = (65539llu * x) & pow2m1[31];
+            memcpy(out + i * nrOfLanes, &x, sizeof(x));
+        }
+        s = x;
     }
     
-    GeneratorInvoker(const GeneratorInvoker&) = delete;
+private:
+    vec_u64 s;
+};
+
+shared_ptr<LanePRNG> RandU::newLanes()
+{
+    return shared_ptr<LanePRNG>(new RandULanes());
+}
+
+/**********************************************************************************
+ *                                                                                *
+ *  Telemetry - time spent in the stages of a run, summed over all threads:       *
+ *    - generate:       PRNG::nextInts and LanePRNG::nextInts                     *
+ *    - pack:           packing the outputs into words                            *
+ *    - analyze:        the walk of SeqAnalyzer and WalkSegment                   *
+ *    - write:          writing to stdout (blocked on the pipe) or the container  *
+ *    - writer waiting: the reorder stage waiting for the next sequence           *
+ *    - workers waiting: workers waiting for the reorder stage to catch up       *
+ *    - output waiting: generation waiting for a free buffer of OutputBuffer      *
+ *  and the occupancy of the ring of OutputBuffer (filled buffers when one was    *
+ *  published, now and on average): a full ring means the consumer of stdout is   *
+ *  the bottleneck, an empty one that generation is.                              *
+ *  Stages are timed per block of about 1024 words, the cost of reading the      *
+ *  clock is negligible.                                                          *
+ *                                                                                *
+ *  During a run the progress (bits/s, ETA) and ns per word of the stages are     *
+ *  printed to stderr every reportInterval seconds and on SIGUSR1, e.g.           *
+ *      kill -USR1 <pid>                                                          *
+ *  and a summary at the end. SIGUSR1 is blocked before the first thread of the   *
+ *  run is started and taken by the reporting thread with sigtimedwait.           *
+ *                                                                                *
+ **********************************************************************************/
+class Telemetry
+{
+public:
+    enum Stage { GENERATE, PACK, ANALYZE, WRITE, WRITER_WAIT, WORKER_WAIT, OUTPUT_WAIT, nrOfStages };
     
-    ~GeneratorInvoker()
+    static long64 now()
     {
-        if (seeds)
-            fclose(seeds);
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
     }
     
-    GeneratorInvoker& operator=(const GeneratorInvoker&) = delete;
+    void add(Stage stage, long64 ns)
+    {
+        stageNs[stage].fetch_add(ns, memory_order_relaxed);
+    }
     
-    void setPRNG(PRNG& prng)
+    void addWords(long64 nrOfWords)
     {
-        this->prng = shared_ptr<PRNG>(&prng);
+        words.fetch_add(nrOfWords, memory_order_relaxed);
     }
     
-    void setPRNG(shared_ptr<PRNG>& prng)
+    void addSequence()
     {
-        this->prng = prng;
+        seqs.fetch_add(1, memory_order_relaxed);
     }
     
-    void setPathToSeeds(char* pathToFile)
+    // filled of nrOfBuffers buffers of the ring of OutputBuffer
+    void setRingOccupancy(long64 filled, int nrOfBuffers)
     {
-        seeds = fopen(pathToFile, "r");
-        if (!seeds)
+        ringFilled.store(filled, memory_order_relaxed);
+        ringSize.store(nrOfBuffers, memory_order_relaxed);
+        ringFilledSum.fetch_add(filled, memory_order_relaxed);
+        ringSamples.fetch_add(1, memory_order_relaxed);
+    }
+    
+    // the run generates nrOfStrings sequences of length bits; reportInterval = 0 - only on SIGUSR1
+    void start(long64 nrOfStrings_, long64 length, int reportInterval_)
+    {
+        nrOfStrings = nrOfStrings_;
+        totalWords = nrOfStrings * (length / 64);
+        reportInterval = reportInterval_;
+        startNs = now();
+        for (auto& ns : stageNs)
+            ns = 0;
+        words = 0;
+        seqs = 0;
+        ringFilled = 0;
+        ringFilledSum = 0;
+        ringSamples = 0;
+        stopping = false;
+        reporter = thread(&Telemetry::reportLoop, this);
+    }
+    
+    // blocks SIGUSR1 in the calling thread and so in all threads it starts later;
+    // has to be called before the first thread of the run is started
+    static void blockReportSignal()
+    {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &set, NULL);
+    }
+    
+    // stops reporting and prints the summary
+    void stop()
+    {
+        if (!reporter.joinable())
+            return;
+        stopping = true;
+        pthread_kill(reporter.native_handle(), SIGUSR1);
+        reporter.join();
+        report("summary");
+    }
+    
+    template <class F>
+    void time(Stage stage, F f)
+    {
+        long64 t = now();
+        f();
+        add(stage, now() - t);
+    }
+    
+private:
+    atomic<long64> stageNs[nrOfStages];
+    atomic<long64> words{0};
+    atomic<long64> seqs{0};
+    atomic<long64> ringFilled{0};
+    atomic<long64> ringSize{0};
+    atomic<long64> ringFilledSum{0};
+    atomic<long64> ringSamples{0};
+    atomic<bool> stopping{false};
+    long64 nrOfStrings = 0;
+    long64 totalWords = 0;
+    long64 startNs = 0;
+    int reportInterval = 0;
+    thread reporter;
+    
+    void reportLoop()
+    {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGUSR1);
+        long64 lastReport = now();
+        while (!stopping)
         {
-            printf("Couldn't open %s\n", pathToFile);
-            exit(1);
+            timespec timeout = {1, 0};
+            int sig = sigtimedwait(&set, NULL, &timeout);
+            if (stopping)
+                break;
+            if (sig == SIGUSR1)
+                report("SIGUSR1");
+            else if (reportInterval > 0 && now() - lastReport >= reportInterval * 1000000000LL)
+                report("progress");
+            else
+                continue;
+            lastReport = now();
         }
     }
     
-    void run(long64 nrOfStrings, long64 length, bool write_data_len)
+    static string formatDuration(double s)
     {
-		fprintf(stderr, "GeneratorInvoker::run(%lld, %lld)\n", nrOfStrings, length);
-        freopen (NULL, "wb", stdout);
-        
-        nrOfStrings -= nrOfSeedsToSkip;
-		if(write_data_len) {
-			fwrite(&nrOfStrings, sizeof(long64), 1, stdout);
-			fwrite(&length, sizeof(long64), 1, stdout);
-		}
-        
-        skipSeeds();
-        
-        for (long64 i = 1; i <= nrOfStrings; ++i)
+        long64 t = (long64) s;
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%lldh%02lldm%02llds", t / 3600, t / 60 % 60, t % 60);
+        return buf;
+    }
+    
+    void report(const char* what)
+    {
+        const double elapsed = (now() - startNs) / 1e9;
+        const long64 w = words;
+        const double rate = elapsed > 0 ? 64.0 * w / elapsed : 0;
+        const string eta = rate > 0 && w < totalWords ? formatDuration(64.0 * (totalWords - w) / rate) : "-";
+        auto perWord = [&](Stage s) { return w > 0 ? (double) stageNs[s] / w : 0.0; };
+        auto seconds = [&](Stage s) { return stageNs[s] / 1e9; };
+        char ring[128] = "";
+        if (ringSamples > 0)
+            snprintf(ring, sizeof(ring), "; output ring %lld/%lld full (mean %.2f), output waiting %.1f s",
+                     (long64) ringFilled, (long64) ringSize, (double) ringFilledSum / ringSamples, seconds(OUTPUT_WAIT));
+        char line[640];
+        snprintf(line, sizeof(line),
+                 "Telemetry (%s): %lld/%lld sequences, %.3g bits/s, elapsed %s, ETA %s\n"
+                 "Telemetry (%s): ns/word generate %.3g, pack %.3g, analyze %.3g; write %.1f s, writer waiting %.1f s, workers waiting %.1f s%s\n",
+                 what, (long64) seqs, nrOfStrings, rate, formatDuration(elapsed).c_str(), eta.c_str(),
+                 what, perWord(GENERATE), perWord(PACK), perWord(ANALYZE), seconds(WRITE), seconds(WRITER_WAIT), seconds(WORKER_WAIT), ring);
+        fputs(line, stderr);
+    }
+};
+
+Telemetry telemetry;
+
+/*************************************************************
+ *                                                           *
+ *  Packing of outputs of W bits into 64-bit words. Output   *
+ *  k occupies bits k*W ... k*W + W - 1 of the stream and    *
+ *  the stream is cut into words starting from the least     *
+ *  significant bit (outputs must be smaller than 2^W).      *
+ *                                                           *
+ *  64/gcd(W,64) outputs make exactly W/gcd(W,64) words      *
+ *  (a period, e.g. 64 outputs of 15 bits make 15 words).    *
+ *  BitPacker<W> is unrolled over the period at compile      *
+ *  time, packTail handles any W and any number of words.    *
+ *                                                           *
+ *************************************************************/
+typedef void (*PackFun)(const ulong64* in, ulong64* out, size_t nrOfWords, uint32 nrOfBits);
+
+// packs outputs into nrOfWords words using only as many outputs as needed
+void packTail(const ulong64* in, ulong64* out, size_t nrOfWords, uint32 nrOfBits)
+{
+    fill(out, out + nrOfWords, 0);
+    size_t nrOfOutputs = (64 * nrOfWords + nrOfBits - 1) / nrOfBits;
+    for (size_t k = 0; k < nrOfOutputs; ++k)
+    {
+        ulong64 off = k * nrOfBits;
+        size_t word = off / 64;
+        uint32 shift = off % 64;
+        out[word] |= in[k] << shift;
+        if (shift + nrOfBits > 64 && word + 1 < nrOfWords)
+            out[word + 1] |= in[k] >> (64 - shift);
+    }
+}
+
+template<uint32 W>
+struct BitPacker
+{
+    static const uint32 outputsPerPeriod = 64 / gcd(W, 64u);
+    static const uint32 wordsPerPeriod = W / gcd(W, 64u);
+    
+    // nrOfWords has to be a multiple of wordsPerPeriod
+    static void pack(const ulong64* in, ulong64* out, size_t nrOfWords, uint32)
+    {
+        for (size_t w = 0; w < nrOfWords; w += wordsPerPeriod)
         {
-            prng->setSeed(nextSeed());
-            
-            if (i % 100 == 0)
-                fprintf(stderr, "Generator: %lld/%lld\n", i, nrOfStrings);
-            generateString(length);
+            packPeriod(in, out + w);
+            in += outputsPerPeriod;
         }
-        fclose(stdout);
     }
     
-    void skipSeeds()
+    static inline void packPeriod(const ulong64* in, ulong64* out)
     {
-        for (int i = 0; i < nrOfSeedsToSkip; ++i)
-            nextSeed();
+        ulong64 acc[wordsPerPeriod] = {};
+#pragma GCC unroll 64
+        for (uint32 k = 0; k < outputsPerPeriod; ++k)
+        {
+            const uint32 word = k * W / 64;
+            const uint32 shift = k * W % 64;
+            acc[word] |= in[k] << shift;
+            if (shift + W > 64)
+                acc[word + 1] |= (in[k] >> (63 - shift)) >> 1; // >> (64 - shift), shift > 0
+        }
+#pragma GCC unroll 64
+        for (uint32 w = 0; w < wordsPerPeriod; ++w)
+            out[w] = acc[w];
+    }
+};
+
+/*************************************************************
+ *                                                           *
+ *  Packs consecutive outputs of a PRNG (getNrOfBits() bits  *
+ *  each) into 64-bit words (chunks). Outputs are taken      *
+ *  from the PRNG in blocks (PRNG::nextInts), never more     *
+ *  than the sequence needs, and packed a block of whole     *
+ *  periods at a time.                                       *
+ *                                                           *
+ *************************************************************/
+// chooses the packer for outputs of nrOfBits bits and the size of a block (about 1024 words, a multiple of the period)
+void getPacker(uint32 nrOfBits, PackFun& pack, size_t& blockWords)
+{
+    uint32 wordsPerPeriod = nrOfBits / gcd(nrOfBits, 64u);
+    blockWords = wordsPerPeriod * max<size_t>(1, 1024 / wordsPerPeriod);
+    switch (nrOfBits)
+    {
+        case 8:  pack = BitPacker<8>::pack;  break;
+        case 15: pack = BitPacker<15>::pack; break;
+        case 24: pack = BitPacker<24>::pack; break;
+        case 31: pack = BitPacker<31>::pack; break;
+        case 64: pack = BitPacker<64>::pack; break;
+        default: pack = packTail;
     }
+}
+
+class ChunkGenerator
+{
+public:
+    ChunkGenerator() = default;
     
-    void run(long64 length, bool write_data_len)
+    ChunkGenerator(shared_ptr<PRNG> prng_)
+        : prng(prng_)
     {
-        int nrOfStrings = getNextIntFromFile();
-        run(nrOfStrings, length, write_data_len);
     }
     
-private:
+    // Has to be called at the beginning of every sequence (of seqLen bits).
+    // With startBit > 0 the PRNG (just seeded) jumps to the output containing
+    // that bit of the sequence and the chunks of bits [startBit, startBit + seqLen)
+    // are generated, shifted from the packed outputs.
+    void reset(ulong64 seqLen, ulong64 startBit = 0)
+    {
+        nrOfBits = prng->getNrOfBits();
+        prng->jump(startBit / nrOfBits);
+        shift = startBit % nrOfBits;
+        wordsLeft = seqLen / 64 + (shift ? 1 : 0);
+        pos = len = 0;
+        setPacker();
+        words.resize(blockWords);
+        outputs.resize(blockWords * 64 / nrOfBits);
+        if (shift)
+            prevWord = nextPacked();
+    }
+    
+    ulong64 nextChunk()
+    {
+        if (shift == 0)
+            return nextPacked();
+        ulong64 word = nextPacked();
+        ulong64 res = (prevWord >> shift) | (word << (64 - shift));
+        prevWord = word;
+        return res;
+    }
+    
+    // time (ns) spent generating and packing so far
+    long64 getBusyNs() const
+    {
+        return busyNs;
+    }
+    
     shared_ptr<PRNG> prng;
-    FILE* seeds = 0;
-    long64 nrOfSeedsToSkip = 0;
-    ulong64 curr;
-    int filled;
+
+private:
+    uint32 nrOfBits = 64;
+    ulong64 wordsLeft = 0; // words of the current sequence not packed yet
+    PackFun pack = packTail;
+    size_t blockWords = 0; // a multiple of the period
+    vector<ulong64> outputs;
+    vector<ulong64> words;
+    size_t pos = 0;
+    size_t len = 0;
+    uint32 shift = 0;      // bits of the first output before startBit
+    ulong64 prevWord = 0;
+    long64 busyNs = 0;
+    
+    void setPacker()
+    {
+        getPacker(nrOfBits, pack, blockWords);
+    }
+    
+    ulong64 nextPacked()
+    {
+        if (pos == len)
+            nextBlock();
+        return words[pos++];
+    }
+    
+    void nextBlock()
+    {
+        len = min<ulong64>(blockWords, wordsLeft);
+        wordsLeft -= len;
+        pos = 0;
+        const long64 t0 = Telemetry::now();
+        size_t nrOfOutputs = (64 * len + nrOfBits - 1) / nrOfBits;
+        prng->nextInts(nrOfBits == 64 ? words.data() : outputs.data(), nrOfOutputs);
+        const long64 t1 = Telemetry::now();
+        if (nrOfBits < 64 && len == blockWords)
+            pack(outputs.data(), words.data(), len, nrOfBits);
+        else if (nrOfBits < 64)
+            packTail(outputs.data(), words.data(), len, nrOfBits); // the last block of a sequence
+        const long64 t2 = Telemetry::now();
+        telemetry.add(Telemetry::GENERATE, t1 - t0);
+        telemetry.add(Telemetry::PACK, t2 - t1);
+        telemetry.addWords(len);
+        busyNs += t2 - t0;
+    }
     
-    void generateString(ulong64 nrOfBits)
+};
+
+/*************************************************************
+ *                                                           *
+ *  ChunkGenerator for all lanes of a LanePRNG: every call   *
+ *  of nextBlock() packs the next block of words of the      *
+ *  sequence of each lane.                                   *
+ *                                                           *
+ *************************************************************/
+class LaneChunkGenerator
+{
+public:
+    static const int nrOfLanes = LanePRNG::nrOfLanes;
+    
+    LaneChunkGenerator(shared_ptr<LanePRNG> lanes_, uint32 nrOfBits_)
+        : lanes(lanes_)
+        , nrOfBits(nrOfBits_)
     {
-        ulong64 nrOfChunks = nrOfBits / 64;
-        curr = 0;
-        filled = 0;
-        for (ulong64 i = 0; i < nrOfChunks; ++i)
+        getPacker(nrOfBits, pack, blockWords);
+        outputs.resize(blockWords * 64 / nrOfBits);
+        interleaved.resize(outputs.size() * nrOfLanes);
+        words.resize(blockWords * nrOfLanes);
+    }
+    
+    // has to be called at the beginning of every nrOfLanes sequences (of seqLen bits)
+    void reset(const uint32* seeds, ulong64 seqLen)
+    {
+        lanes->setSeeds(seeds);
+        wordsLeft = seqLen / 64;
+    }
+    
+    // packs the next block of words of every lane, returns the number of words
+    // per lane (0 when the sequences are complete)
+    size_t nextBlock()
+    {
+        size_t len = min<ulong64>(blockWords, wordsLeft);
+        wordsLeft -= len;
+        if (len == 0)
+            return 0;
+        size_t nrOfOutputs = (64 * len + nrOfBits - 1) / nrOfBits;
+        const long64 t0 = Telemetry::now();
+        lanes->nextInts(interleaved.data(), nrOfOutputs);
+        const long64 t1 = Telemetry::now();
+        for (int l = 0; l < nrOfLanes; ++l)
         {
-            ulong64 chunk = nextChunk();
-            //fprintf(stderr, "filled = %d\n", filled);
-            fwrite(&chunk, sizeof(ulong64), 1, stdout);
+            for (size_t k = 0; k < nrOfOutputs; ++k)
+                outputs[k] = interleaved[k * nrOfLanes + l];
+            ulong64* out = &words[l * blockWords];
+            if (nrOfBits == 64)
+                copy(outputs.begin(), outputs.begin() + len, out);
+            else if (len == blockWords)
+                pack(outputs.data(), out, len, nrOfBits);
+            else
+                packTail(outputs.data(), out, len, nrOfBits);
         }
+        telemetry.add(Telemetry::GENERATE, t1 - t0);
+        telemetry.add(Telemetry::PACK, Telemetry::now() - t1);
+        telemetry.addWords(len * nrOfLanes);
+        return len;
     }
     
-    ulong64 nextChunk()
+    const ulong64* getWords(int lane) const
+    {
+        return &words[lane * blockWords];
+    }
+    
+private:
+    shared_ptr<LanePRNG> lanes;
+    uint32 nrOfBits;
+    ulong64 wordsLeft = 0;
+    PackFun pack;
+    size_t blockWords;
+    vector<ulong64> interleaved; // outputs of all lanes as returned by LanePRNG::nextInts
+    vector<ulong64> outputs;     // outputs of a single lane
+    vector<ulong64> words;       // packed words, blockWords per lane
+};
+
+/**********************************************************************************
+ *                                                                                *
+ *  OutputBuffer - generated words are written to a file descriptor in large      *
+ *                 page-aligned buffers instead of a call of fwrite per word.     *
+ *                                                                                *
+ *  The buffers form a ring of nrOfBuffers: the generating thread fills one       *
+ *  while a writer thread writes the full ones, so generation continues while     *
+ *  the pipe or the disk catches up. The ring has a single producer and a         *
+ *  single consumer and no locks: the producer publishes filled buffers by        *
+ *  advancing published, the writer returns them by advancing released; a side   *
+ *  with nothing to do spins briefly and then sleeps with growing pauses.         *
+ *                                                                                *
+ *  If the descriptor is a pipe (e.g. to jl/Main.jl), a buffer has the capacity   *
+ *  of the pipe and its pages are given to the pipe with vmsplice, without        *
+ *  copying them. A buffer is returned only after the whole next one got into     *
+ *  the pipe, i.e. when the pipe does not hold any of its pages any more. Other   *
+ *  files get one write per buffer. The ring is mapped with mmap, so pages still  *
+ *  in the pipe at the end are not handed out again by the heap.                  *
+ *                                                                                *
+ **********************************************************************************/
+class OutputBuffer
+{
+public:
+    static const int nrOfBuffers = 4;
+    
+    // bufferSize - of all buffers of the ring
+    OutputBuffer(int fd_, size_t bufferSize)
+        : fd(fd_)
     {
-        ulong64 r = 0;
-        int nrOfBits = prng->getNrOfBits();
-        while (filled < 64)
+        const size_t page = sysconf(_SC_PAGESIZE);
+        size = max<size_t>(1, bufferSize / nrOfBuffers / page) * page;
+#ifdef __linux__
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode))
         {
-            r = prng->nextInt();
-            curr += (r << filled);
-            filled += nrOfBits;
+            // a buffer has to fill the pipe exactly, the pipe is enlarged if allowed
+            int pipeSize = -1;
+            for (size_t s = size; s >= page && pipeSize < 0; s /= 2)
+                pipeSize = fcntl(fd, F_SETPIPE_SZ, s);
+            if (pipeSize < 0)
+                pipeSize = fcntl(fd, F_GETPIPE_SZ);
+            if (pipeSize > 0 && pipeSize % page == 0)
+            {
+                useSplice = true;
+                size = pipeSize;
+            }
         }
-        int used = nrOfBits + 64 - filled;
-        ulong64 res = curr;
-        curr = used < 64 ? (r >> used) : 0;
-        filled = nrOfBits - used;
-        return res;
+#endif
+        // mapped separately from the heap, see ~OutputBuffer
+        void* mem = mmap(NULL, nrOfBuffers * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+        {
+            fprintf(stderr, "OutputBuffer: cannot allocate %zu bytes\n", nrOfBuffers * size);
+            exit(1);
+        }
+        buf = (char*) mem;
+        writer = thread(&OutputBuffer::writeLoop, this);
     }
     
-    int nextSeed()
+    OutputBuffer(const OutputBuffer&) = delete;
+    
+    // writes all buffers and stops the writer; the pipe may still hold pages of the
+    // last buffers, unmapping leaves them to the pipe and they are never reused by
+    // this process, as freed heap memory would be
+    ~OutputBuffer()
     {
-        static int def_first_seed = 112358;
-        
-        if (seeds)
-            return getNextIntFromFile() + 1000000001;
-        else
-            return def_first_seed++;
+        flush();
+        closed.store(true, memory_order_release);
+        writer.join();
+        munmap(buf, nrOfBuffers * size);
     }
     
-    int getNextIntFromFile()
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    
+    // space for nrOfWords words (reduced to the space left) to be filled and committed
+    ulong64* reserve(size_t& nrOfWords)
     {
-        int val;
-        fscanf(seeds, "%d", &val);
-        return val;
+        if (fill == size)
+            flush();
+        nrOfWords = min(nrOfWords, (size - fill) / sizeof(ulong64));
+        return (ulong64*) (current() + fill);
+    }
+    
+    void commit(size_t nrOfWords)
+    {
+        fill += nrOfWords * sizeof(ulong64);
+    }
+    
+    void write(const void* data, size_t len)
+    {
+        const char* p = (const char*) data;
+        while (len > 0)
+        {
+            if (fill == size)
+                flush();
+            size_t n = min(len, size - fill);
+            memcpy(current() + fill, p, n);
+            fill += n;
+            p += n;
+            len -= n;
+        }
+    }
+    
+    // passes the current buffer to the writer and waits for a free one
+    void flush()
+    {
+        if (fill == 0)
+            return;
+        const ulong64 next = published.load(memory_order_relaxed);
+        fills[next % nrOfBuffers] = fill;
+        published.store(next + 1, memory_order_release);
+        fill = 0;
+        telemetry.setRingOccupancy(next + 1 - released.load(memory_order_relaxed), nrOfBuffers);
+        telemetry.time(Telemetry::OUTPUT_WAIT, [&]() {
+            waitFor([&]() { return next + 1 - released.load(memory_order_acquire) < nrOfBuffers; });
+        });
+    }
+    
+private:
+    int fd;
+    char* buf;
+    size_t size;                      // of a buffer
+    size_t fill = 0;                  // bytes of the current buffer
+    size_t fills[nrOfBuffers];        // bytes of the published buffers
+    atomic<ulong64> published{0};     // buffers given to the writer so far
+    atomic<ulong64> released{0};      // buffers the producer may refill
+    atomic<bool> closed{false};
+    bool useSplice = false;
+    thread writer;
+    
+    char* current()
+    {
+        return buf + published.load(memory_order_relaxed) % nrOfBuffers * size;
+    }
+    
+    template <class F>
+    static void waitFor(F ready)
+    {
+        long64 pauseUs = 1;
+        for (int i = 0; !ready(); ++i)
+        {
+            if (i < 64)
+            {
+                this_thread::yield();
+                continue;
+            }
+            this_thread::sleep_for(chrono::microseconds(pauseUs));
+            pauseUs = min<long64>(2 * pauseUs, 1000);
+        }
+    }
+    
+    void writeLoop()
+    {
+        ulong64 next = 0;
+        while (true)
+        {
+            bool done = false;
+            waitFor([&]() {
+                done = closed.load(memory_order_acquire); // read before published, so nothing is missed
+                return published.load(memory_order_acquire) > next || done;
+            });
+            if (published.load(memory_order_acquire) == next)
+                break;
+            writeBuffer(buf + next % nrOfBuffers * size, fills[next % nrOfBuffers]);
+            ++next;
+            // the pipe may still hold pages of the previous buffer only
+            released.store(useSplice ? next - 1 : next, memory_order_release);
+        }
+        released.store(next, memory_order_release);
+    }
+    
+    void writeBuffer(const char* p, size_t len)
+    {
+        const long64 t0 = Telemetry::now();
+        while (len > 0)
+        {
+            ssize_t res = useSplice ? splicePages(p, len) : ::write(fd, p, len);
+            if (res < 0 && errno == EINTR)
+                continue;
+            if (res < 0)
+            {
+                perror("OutputBuffer");
+                exit(1);
+            }
+            p += res;
+            len -= res;
+        }
+        telemetry.add(Telemetry::WRITE, Telemetry::now() - t0);
+    }
+    
+    ssize_t splicePages(const char* p, size_t len)
+    {
+#ifdef __linux__
+        struct iovec iov = { (void*) p, len };
+        return vmsplice(fd, &iov, 1, 0);
+#else
+        return -1;
+#endif
     }
 };
 
-void wrongArgs(int argc, char** argv)
+class GeneratorInvoker
 {
-        printf("Usage: %s [prng name] [number of strings | path to seeds] [log2 of length >= 6] [nrOfSeeds to skip] [-nolen] [-f step size for FlawedDyckMT] \n", argv[0]);
-        exit(1);
-}
-
-shared_ptr<PRNG> getPRNG(char* name, uint32 log_len = 26, long64 step_flawed = 100)
-{	
-    if (strcmp(name, "z_czapy") == 0)
+public:
+    GeneratorInvoker() = default;
+    
+    GeneratorInvoker(shared_ptr<PRNG>& prng_)
+        : gen(prng_)
     {
-        return shared_ptr<PRNG>(new LCG(1e9, 1234, 3, 8));
     }
-    else if (strcmp(name, "Rand") == 0)
+    
+    GeneratorInvoker(shared_ptr<PRNG>& prng_, long64 nrOfSeedsToSkip_)
+        : gen(prng_)
+        , nrOfSeedsToSkip(nrOfSeedsToSkip_)
     {
-        return shared_ptr<PRNG>(new LCG(2147483648LL, 1103515245, 12345, 31));
     }
-    else if (strcmp(name, "Rand0") == 0)
+    
+    GeneratorInvoker(const GeneratorInvoker&) = delete;
+    
+    ~GeneratorInvoker()
+    {
+        if (seeds)
+            fclose(seeds);
+    }
+    
+    GeneratorInvoker& operator=(const GeneratorInvoker&) = delete;
+    
+    void setPRNG(PRNG& prng)
     {
-        return shared_ptr<PRNG>(new LCG(2147483648LL, 1103515245, 12345, 8));
+        gen.prng = shared_ptr<PRNG>(&prng);
     }
-    else if (strcmp(name, "Rand1") == 0)
+    
+    void setPRNG(shared_ptr<PRNG>& prng)
     {
-        return shared_ptr<PRNG>(
-            new SomeBits(
-                shared_ptr<PRNG>(new LCG(2147483648LL, 1103515245, 12345, 31)),
-                15, 8
-            ) );
+        gen.prng = prng;
     }
-    else if (strcmp(name, "Rand3") == 0)
+    
+    /*
+     * The outputs of a test (asin or lil) of the analyzed sequences:
+     *   - results:        the values of the statistic for each sequence
+     *   - histogram:      their counts in a ResultHistogram, written to
+     *                     pathToHistogram at the end of the run
+     *   - fineHistogram:  their counts in a FineHistogram (2^16 bins), written
+     *                     to pathToFineHistogram; worker threads count their
+     *                     sequences in their own copies
+     *   - sequentialTest: tests the results so far repeatedly and stops the
+     *                     run as soon as the PRNG fails decisively; the
+     *                     histograms then record only the seeds processed
+     *                     until then and are marked as early-stopped
+     * All but results are optional.
+     */
+    struct TestOutputs
+    {
+        TestType type = TEST_ASIN;
+        shared_ptr<ResultWriter> results;
+        shared_ptr<ResultHistogram> histogram;
+        string pathToHistogram;
+        shared_ptr<FineHistogram> fineHistogram;
+        string pathToFineHistogram;
+        shared_ptr<SequentialTest> sequentialTest;
+    };
+    
+    /*
+     * Instead of writing the generated bits to stdout, feed every 64-bit word
+     * to the analyzer; the statistics of all tests added with addTest are
+     * computed from the same walk, so every sequence is generated once.
+     */
+    void setAnalyzer(shared_ptr<SeqAnalyzer>& analyzer_)
     {
-        return shared_ptr<PRNG>(
-            new SomeBits(
-                shared_ptr<PRNG>(new LCG(2147483648LL, 1103515245, 12345, 31)),
-                30, 23
-            ) );
+        analyzer = analyzer_;
     }
-    else if (strcmp(name, "Minstd") == 0)
+    
+    void addTest(const TestOutputs& test)
     {
-        return shared_ptr<PRNG>(new LCG(2147483647, 16807, 0, 31));
+        tests.push_back(test);
     }
-    else if (strcmp(name, "Minstd0") == 0)
+    
+    /*
+     * Generate only the shardNr-th (1..nrOfShards) of nrOfShards contiguous
+     * ranges of seeds (of those left after skipping), so that a run can be
+     * split between machines; histograms of the shards can be merged
+     * (mergeShards.cpp).
+     */
+    void setShard(int shardNr_, int nrOfShards_)
     {
-        return shared_ptr<PRNG>(new LCG(2147483647, 16807, 0, 8));
+        shardNr = shardNr_;
+        nrOfShards = nrOfShards_;
     }
-    else if (strcmp(name, "Minstd1") == 0)
+    
+    /*
+     * Generate sequences for different seeds concurrently on nrOfThreads
+     * worker threads. Each worker uses its own instance of the PRNG created
+     * with newPRNG. The output (and the order of the results) is the same
+     * as in the serial run. PRNGs with a multi-lane engine (PRNG::newLanes)
+     * are run this way also with a single thread.
+     */
+    void setThreads(int nrOfThreads_, function<shared_ptr<PRNG>()> newPRNG_)
     {
-        return shared_ptr<PRNG>(
-            new SomeBits(
-                shared_ptr<PRNG>(new LCG(2147483647, 16807, 0, 31)),
-                15, 8
-            ) );
+        nrOfThreads = nrOfThreads_;
+        newPRNG = newPRNG_;
     }
-    else if (strcmp(name, "NewMinstd") == 0)
+    
+    /*
+     * Split every sequence into nrOfSegments (a power of 2) contiguous
+     * segments generated independently (in parallel with nrOfThreads > 1),
+     * the PRNG of a segment jumps to its start (PRNG::jump). Used only for
+     * PRNGs which can jump ahead quickly.
+     */
+    void setSegments(int nrOfSegments_)
     {
-        return shared_ptr<PRNG>(new LCG(2147483647, 48271, 0, 31));
+        nrOfSegments = nrOfSegments_;
     }
-    else if (strcmp(name, "NewMinstd0") == 0)
+    
+    /*
+     * Size of the buffer in which the sequences are passed to stdout
+     * (see OutputBuffer).
+     */
+    void setOutputBufferSize(size_t outputBufferSize_)
     {
-        return shared_ptr<PRNG>(new LCG(2147483647, 48271, 0, 8));
+        outputBufferSize = outputBufferSize_;
     }
-    else if (strcmp(name, "NewMinstd1") == 0)
+    
+    /*
+     * Instead of writing the sequences to stdout, write them (and their
+     * seeds) to a SeqContainer file; workers write their sequences
+     * directly into it, each into its own region.
+     */
+    void setContainer(const char* pathToContainer_)
     {
-        return shared_ptr<PRNG>(
-            new SomeBits(
-                shared_ptr<PRNG>(new LCG(2147483647, 48271, 0, 31)),
-                15, 8
-            ) );
+        pathToContainer = pathToContainer_;
     }
-    else if (strcmp(name, "NewMinstd3") == 0)
+    
+    /*
+     * Name of the PRNG (with the options changing its output) recorded in
+     * the SeqContainer file and in the description of the run of the results
+     * (ResultWriter::setRun).
+     */
+    void setPRNGName(const string& prngName_)
     {
-        return shared_ptr<PRNG>(
-            new SomeBits(
-                shared_ptr<PRNG>(new LCG(2147483647, 48271, 0, 31)),
-                30, 23
-            ) );
+        prngName = prngName_;
     }
-    else if (strcmp(name, "CMRG") == 0)
+    
+    /*
+     * Print the progress and the time spent in the stages of the run
+     * (see Telemetry) every reportInterval seconds, 0 - only on SIGUSR1.
+     */
+    void setReportInterval(int reportInterval_)
     {
-        return shared_ptr<PRNG>(new CMRG());
+        reportInterval = reportInterval_;
     }
-    else if (strcmp(name, "CMRG0") == 0)
+    
+    void setPathToSeeds(char* pathToFile)
     {
-        return shared_ptr<PRNG>(
-            new SomeBits(
-                shared_ptr<PRNG>(new CMRG()),
-                7, 0
-            ) );
+        seedSource = pathToFile;
+        seeds = fopen(pathToFile, "r");
+        if (!seeds)
+        {
+            printf("Couldn't open %s\n", pathToFile);
+            exit(1);
+        }
     }
-    else if (strcmp(name, "CMRG1") == 0)
+    
+    void run(long64 nrOfStrings, long64 length, bool write_data_len)
     {
-        return shared_ptr<PRNG>(
-            new SomeBits(
-                shared_ptr<PRNG>(new CMRG()),
-                15, 8
-            ) );
+		fprintf(stderr, "GeneratorInvoker::run(%lld, %lld)\n", nrOfStrings, length);
+        Telemetry::blockReportSignal(); // before the writer of OutputBuffer and the workers are started
+        nrOfStrings -= nrOfSeedsToSkip;
+        nrOfAllStrings = nrOfStrings; // of all shards, the skipped seeds are not part of the run
+        const long64 firstOfShard = nrOfStrings * (shardNr - 1) / nrOfShards;
+        nrOfStrings = nrOfStrings * shardNr / nrOfShards - firstOfShard;
+        firstSeedNr = nrOfSeedsToSkip + firstOfShard;
+        if (pathToContainer && !analyzer)
+            container.reset(new SeqContainerWriter(pathToContainer, prngName.c_str(), seedSource, firstSeedNr, nrOfStrings, length));
+        else if (!analyzer)
+            out.reset(new OutputBuffer(fileno(stdout), outputBufferSize));
+        // a resumed run has to be the same as the one of the results
+        char run[512];
+        snprintf(run, sizeof(run), "prng %s\nseeds %s\nfirst %lld\ncount %lld\nlength %lld\n",
+                 prngName.c_str(), *seedSource ? seedSource : "default", firstSeedNr, nrOfStrings, length);
+        for (TestOutputs& test : tests)
+        {
+            test.results->setRun(run);
+            if (test.histogram)
+                test.histogram->setSeeds(seedSource, firstSeedNr, nrOfStrings, nrOfAllStrings);
+            if (test.fineHistogram)
+                test.fineHistogram->setSeeds(seedSource, firstSeedNr, nrOfStrings, nrOfAllStrings);
+        }
+    
+        // a resumed run continues after the results already written (of all tests)
+        long64 nrOfDone = tests.empty() ? 0 : nrOfStrings;
+        for (TestOutputs& test : tests)
+            nrOfDone = min<long64>(nrOfDone, test.results->getPreviousResults().size());
+        for (TestOutputs& test : tests)
+        {
+            test.results->keepPrevious(nrOfDone);
+            const vector<vector<double>>& previous = test.results->getPreviousResults();
+            for (long64 i = 0; i < nrOfDone && test.histogram; ++i)
+                test.histogram->addResult(previous[i]);
+            for (long64 i = 0; i < nrOfDone && test.fineHistogram; ++i)
+                test.fineHistogram->addResult(previous[i]);
+            for (long64 i = 0; i < nrOfDone && test.sequentialTest; ++i)
+                stopped = test.sequentialTest->addResult(previous[i]) || stopped;
+        }
+        if (nrOfDone > 0)
+            fprintf(stderr, "GeneratorInvoker: resuming after %lld sequences\n", nrOfDone);
+        // the run was stopped early before, or the previous results are decisive already
+        if (stopped)
+            nrOfDone = nrOfStrings;
+    
+		if(write_data_len && out) {
+			out->write(&nrOfStrings, sizeof(long64));
+			out->write(&length, sizeof(long64));
+		}
+    
+        skipSeeds(firstSeedNr + nrOfDone);
+        nrOfStrings -= nrOfDone;
+        firstSeqNr = firstOfShard + nrOfDone;
+        telemetry.start(nrOfStrings, length, reportInterval);
+    
+        if (nrOfSegments > 1 && !gen.prng->canJump())
+        {
+            fprintf(stderr, "GeneratorInvoker: PRNG cannot jump ahead, sequences are not split\n");
+            nrOfSegments = 1;
+        }
+    
+        // Written to stdout, the sequences of all lanes wait in memory
+        // until they are written, so lanes are used only for short sequences.
+        shared_ptr<LanePRNG> lanes = gen.prng->newLanes();
+        if (lanes && out && length / 8 * LanePRNG::nrOfLanes * 2 * nrOfThreads > maxLaneBufferedBytes)
+            lanes = shared_ptr<LanePRNG>();
+        if (nrOfSegments > 1)
+            lanes = shared_ptr<LanePRNG>();
+    
+        if (nrOfThreads > 1 || lanes || nrOfSegments > 1)
+        {
+            runParallel(nrOfStrings, length, lanes);
+            closeOutputs();
+            return;
+        }
+    
+        for (long64 i = 1; i <= nrOfStrings && !stopped; ++i)
+        {
+            int seed = nextSeed();
+            gen.prng->setSeedNr(firstSeqNr + i - 1);
+            gen.prng->setSeed(seed);
+            if (container)
+                container->setSeed(i - 1, seed);
+    
+            if (i % 100 == 0)
+                fprintf(stderr, "Generator: %lld/%lld\n", i, nrOfStrings);
+            generateString(length, i - 1);
+            if (analyzer)
+                addResults(*analyzer, true);
+            telemetry.addSequence();
+        }
+        closeOutputs();
     }
-    else if (strcmp(name, "SBorland") == 0)
+    
+    // default seeds are consecutive numbers, seeds from a file have to be read
+    void skipSeeds(long64 nrOfSeeds)
     {
-        return getShifted(shared_ptr<PRNG>(new BorlandPRNG()), 7);
+        if (!seeds)
+            defaultSeed += nrOfSeeds;
+        for (long64 i = 0; i < nrOfSeeds && seeds; ++i)
+            nextSeed();
     }
-    else if (strcmp(name, "C_PRG") == 0)
+    
+    void run(long64 length, bool write_data_len)
     {
-        return shared_ptr<PRNG>(new C_PRG());
+        int nrOfStrings = getNextIntFromFile();
+        run(nrOfStrings, length, write_data_len);
+    }
+
+private:
+    // words of a sequence are passed from a worker to the writer in blocks of this size
+    static const ulong64 blockLen = 1 << 15;
+    // maximal size of not yet written blocks of a single sequence
+    static const ulong64 maxBufferedBytes = 1 << 24;
+    // maximal size of sequences generated with lanes waiting to be written
+    static const long64 maxLaneBufferedBytes = 1 << 30;
+    
+    /*
+     * A sequence (or its segment) generated by a worker thread. Blocks of
+     * its words (or the state of the walk) wait here until all previous
+     * sequences are written.
+     */
+    struct SeqSlot
+    {
+        list<vector<ulong64>> blocks;
+        shared_ptr<SeqAnalyzer> analyzer; // the first segment of a sequence
+        shared_ptr<WalkSegment> walk;     // other segments
+        bool done = false;
+    };
+    
+    ChunkGenerator gen;
+    FILE* seeds = 0;
+    long64 nrOfSeedsToSkip = 0;
+    shared_ptr<SeqAnalyzer> analyzer;
+    vector<TestOutputs> tests;
+    int nrOfThreads = 1;
+    function<shared_ptr<PRNG>()> newPRNG;
+    int nrOfSegments = 1;
+    size_t outputBufferSize = 1 << 22;
+    unique_ptr<OutputBuffer> out;
+    const char* pathToContainer = NULL;
+    string prngName;
+    const char* seedSource = "";
+    unique_ptr<SeqContainerWriter> container;
+    bool stopped = false;             // by the sequential test of a test
+    long64 firstSeedNr = 0;
+    // index of the first sequence generated in the whole run (of all shards,
+    // counted from the first seed not skipped), after the sequences done before
+    // a resumed run; the flawed sequences of Flawed and FlawedDyckMT depend on it
+    long64 firstSeqNr = 0;
+    long64 nrOfAllStrings = 0;
+    int shardNr = 1;
+    int nrOfShards = 1;
+    int defaultSeed = 112358;
+    int reportInterval = 60;
+    
+    // the results of an analyzed sequence for all tests, and its counts in the
+    // fine histograms unless the workers count them
+    void addResults(const SeqAnalyzer& an, bool withFineHistograms)
+    {
+        for (TestOutputs& test : tests)
+        {
+            const vector<double> res = an.getResults(test.type);
+            test.results->addResult(res);
+            if (test.histogram)
+                test.histogram->addResult(res);
+            if (test.fineHistogram && withFineHistograms)
+                test.fineHistogram->addSequence(an);
+            if (test.sequentialTest && test.sequentialTest->addResult(res))
+                stopped = true;
+        }
     }
-    else if (strcmp(name, "SVIS") == 0)
+    
+    // flushes and closes the outputs of the run, prints the summary of Telemetry
+    void closeOutputs()
     {
-        return getShifted(shared_ptr<PRNG>(new VisualPRNG()), 7); // Discard 7 LSBs produced by the PRNG
+        out.reset();
+        container.reset();
+        telemetry.stop();
+        for (TestOutputs& test : tests)
+        {
+            if (test.sequentialTest)
+                test.sequentialTest->printSummary(stderr);
+            if (stopped && test.sequentialTest)
+            {
+                // the seeds processed were the first ones of the range of the run
+                const long64 nrOfSeedsUsed = test.sequentialTest->getNrOfSeqs();
+                if (test.histogram)
+                {
+                    test.histogram->setSeeds(seedSource, firstSeedNr, nrOfSeedsUsed, nrOfAllStrings);
+                    test.histogram->setEarlyStopped();
+                }
+                if (test.fineHistogram)
+                {
+                    test.fineHistogram->setSeeds(seedSource, firstSeedNr, nrOfSeedsUsed, nrOfAllStrings);
+                    test.fineHistogram->setEarlyStopped();
+                }
+                test.results->setEarlyStopped();
+            }
+            if (test.histogram)
+                test.histogram->write(test.pathToHistogram.c_str());
+            if (test.fineHistogram)
+                test.fineHistogram->write(test.pathToFineHistogram.c_str());
+        }
+        fclose(stdout);
     }
-    else if (strcmp(name, "Mersenne") == 0)
+    
+    void generateString(ulong64 nrOfBits, long64 seqNr)
     {
-        return shared_ptr<PRNG>(new Mersenne());
+        ulong64 nrOfChunks = nrOfBits / 64;
+        gen.reset(nrOfBits);
+        if (analyzer)
+        {
+            const long64 t0 = Telemetry::now() - gen.getBusyNs();
+            analyzer->reset();
+            for (ulong64 i = 0; i < nrOfChunks; ++i)
+                analyzer->addWord(gen.nextChunk());
+            telemetry.add(Telemetry::ANALYZE, Telemetry::now() - gen.getBusyNs() - t0);
+            return;
+        }
+        if (container)
+        {
+            vector<ulong64> block(min(nrOfChunks, blockLen));
+            for (ulong64 i = 0; i < nrOfChunks; i += block.size())
+            {
+                size_t n = min<ulong64>(block.size(), nrOfChunks - i);
+                for (size_t j = 0; j < n; ++j)
+                    block[j] = gen.nextChunk();
+                telemetry.time(Telemetry::WRITE, [&]() { container->writeWords(seqNr, i, block.data(), n); });
+            }
+            return;
+        }
+        // the words are generated directly into the output buffer
+        for (ulong64 i = 0; i < nrOfChunks; )
+        {
+            size_t n = nrOfChunks - i;
+            ulong64* words = out->reserve(n);
+            for (size_t j = 0; j < n; ++j)
+                words[j] = gen.nextChunk();
+            out->commit(n);
+            i += n;
+        }
     }
-    else if (strcmp(name, "RANDU") == 0)
+    
+    /*
+     * Workers take consecutive units of work and generate them, at most
+     * 2*nrOfThreads units ahead of the one being written. A unit is a whole
+     * sequence, a group of nrOfLanes consecutive sequences generated
+     * together with lanes, or one of nrOfSegments segments of a sequence.
+     * The calling thread is the reorder stage: it writes the sequences
+     * (or results) strictly in the order of seeds. With the analyzer the
+     * walk of the first segment of a sequence is continued there with the
+     * WalkSegments of the other segments.
+     */
+    void runParallel(long64 nrOfStrings, long64 length, shared_ptr<LanePRNG> lanes)
+    {
+        vector<int> seedList(nrOfStrings);
+        for (long64 i = 0; i < nrOfStrings; ++i)
+        {
+            seedList[i] = nextSeed();
+            if (container)
+                container->setSeed(i, seedList[i]);
+        }
+    
+        const long64 nrOfUnits = nrOfStrings * nrOfSegments; // unit u is segment u % nrOfSegments of sequence u / nrOfSegments
+        const ulong64 segLen = length / nrOfSegments;
+        const ulong64 nrOfChunks = segLen / 64;
+        const ulong64 chunksPerBlock = min(nrOfChunks, blockLen);
+        const size_t maxBlocks = max<ulong64>(1, maxBufferedBytes / (chunksPerBlock * sizeof(ulong64)));
+        const long64 groupSize = lanes ? LanePRNG::nrOfLanes : 1;
+        const long64 window = 2 * nrOfThreads * groupSize;
+    
+        vector<SeqSlot> slots(nrOfUnits);
+        long64 nextToGenerate = 0;
+        long64 nextToWrite = 0;
+        long64 endUnit = nrOfUnits; // less if the run is stopped early
+        mutex m;
+        condition_variable produced, consumed;
+    
+        // takes the next at most groupSize units, false if all were taken
+        auto takeUnits = [&](long64& first, long64& count)
+        {
+            unique_lock<mutex> lock(m);
+            telemetry.time(Telemetry::WORKER_WAIT, [&]() {
+                consumed.wait(lock, [&]() {
+                    return nextToGenerate >= endUnit || nextToGenerate < nextToWrite + window;
+                });
+            });
+            if (nextToGenerate >= endUnit)
+                return false;
+            first = nextToGenerate;
+            count = min(groupSize, endUnit - first);
+            nextToGenerate += count;
+            return true;
+        };
+    
+        // a block of words of unit u starting at the given word of its sequence;
+        // a worker generating only this unit waits if too many of its blocks
+        // are not written yet. Blocks go directly to the container, if any.
+        auto push = [&](long64 u, ulong64 wordOffset, vector<ulong64>& block, bool bounded)
+        {
+            if (container)
+            {
+                telemetry.time(Telemetry::WRITE, [&]() {
+                    container->writeWords(u / nrOfSegments, wordOffset, block.data(), block.size());
+                });
+                return;
+            }
+            unique_lock<mutex> lock(m);
+            if (bounded)
+                telemetry.time(Telemetry::WORKER_WAIT, [&]() {
+                    consumed.wait(lock, [&]() { return slots[u].blocks.size() < maxBlocks; });
+                });
+            slots[u].blocks.push_back(move(block));
+            produced.notify_all();
+        };
+    
+        auto finish = [&](long64 u, shared_ptr<SeqAnalyzer> an, shared_ptr<WalkSegment> walk)
+        {
+            lock_guard<mutex> lock(m);
+            slots[u].analyzer = an;
+            slots[u].walk = walk;
+            slots[u].done = true;
+            produced.notify_all();
+        };
+    
+        auto work = [&](ChunkGenerator g, shared_ptr<SeqAnalyzer> an, vector<FineHistogram>* fine)
+        {
+            long64 u, count;
+            while (takeUnits(u, count))
+            {
+                long64 i = u / nrOfSegments;
+                ulong64 startBit = (u % nrOfSegments) * segLen;
+                g.prng->setSeedNr(firstSeqNr + i);
+                g.prng->setSeed(seedList[i]);
+                g.reset(segLen, startBit);
+                const long64 t0 = Telemetry::now() - g.getBusyNs();
+                if (an && startBit == 0)
+                {
+                    an->reset();
+                    for (ulong64 c = 0; c < nrOfChunks; ++c)
+                        an->addWord(g.nextChunk());
+                    telemetry.add(Telemetry::ANALYZE, Telemetry::now() - g.getBusyNs() - t0);
+                    for (size_t k = 0; fine && k < fine->size(); ++k)
+                        (*fine)[k].addSequence(*an);
+                    finish(u, make_shared<SeqAnalyzer>(*an), nullptr);
+                    continue;
+                }
+                if (an)
+                {
+                    shared_ptr<WalkSegment> walk(new WalkSegment());
+                    for (ulong64 c = 0; c < nrOfChunks; ++c)
+                        walk->addWord(g.nextChunk());
+                    telemetry.add(Telemetry::ANALYZE, Telemetry::now() - g.getBusyNs() - t0);
+                    finish(u, nullptr, walk);
+                    continue;
+                }
+                for (ulong64 c = 0; c < nrOfChunks; c += chunksPerBlock)
+                {
+                    vector<ulong64> block(chunksPerBlock);
+                    for (ulong64 j = 0; j < chunksPerBlock; ++j)
+                        block[j] = g.nextChunk();
+                    push(u, startBit / 64 + c, block, true);
+                }
+                finish(u, nullptr, nullptr);
+            }
+        };
+    
+        // sequences of all lanes are kept in memory until written (see run)
+        auto workLanes = [&](LaneChunkGenerator g, vector<SeqAnalyzer> an, vector<FineHistogram>* fine)
+        {
+            const int nrOfLanes = LanePRNG::nrOfLanes;
+            long64 first, count;
+            while (takeUnits(first, count))
+            {
+                uint32 laneSeeds[nrOfLanes];
+                for (int l = 0; l < nrOfLanes; ++l)
+                    laneSeeds[l] = seedList[first + min<long64>(l, count - 1)]; // unused lanes repeat the last seed
+                g.reset(laneSeeds, length);
+                for (long64 l = 0; l < count && analyzer; ++l)
+                    an[l].reset();
+                vector<ulong64> pending[nrOfLanes];
+                ulong64 pushed[nrOfLanes] = {0};
+                while (size_t len = g.nextBlock())
+                {
+                    for (long64 l = 0; l < count; ++l)
+                    {
+                        const ulong64* words = g.getWords(l);
+                        if (analyzer)
+                        {
+                            telemetry.time(Telemetry::ANALYZE, [&]() {
+                                for (size_t j = 0; j < len; ++j)
+                                    an[l].addWord(words[j]);
+                            });
+                            continue;
+                        }
+                        pending[l].insert(pending[l].end(), words, words + len);
+                        if (pending[l].size() >= chunksPerBlock)
+                        {
+                            pushed[l] += pending[l].size();
+                            push(first + l, pushed[l] - pending[l].size(), pending[l], false);
+                            pending[l].clear();
+                        }
+                    }
+                }
+                for (long64 l = 0; l < count; ++l)
+                {
+                    if (!pending[l].empty())
+                        push(first + l, pushed[l], pending[l], false);
+                    for (size_t k = 0; fine && k < fine->size(); ++k)
+                        (*fine)[k].addSequence(an[l]);
+                    finish(first + l, analyzer ? make_shared<SeqAnalyzer>(an[l]) : nullptr, nullptr);
+                }
+            }
+        };
+    
+        // fine histograms of the workers, added up when they finish; sequences
+        // which are split, or may be generated after the run is stopped, are
+        // counted by the reorder stage instead
+        bool fineInWorkers = nrOfSegments == 1;
+        vector<FineHistogram> workerFines; // of the tests with a fine histogram
+        for (TestOutputs& test : tests)
+        {
+            fineInWorkers = fineInWorkers && !test.sequentialTest;
+            if (test.fineHistogram)
+                workerFines.push_back(*test.fineHistogram);
+        }
+        fineInWorkers = fineInWorkers && !workerFines.empty();
+        for (auto& f : workerFines)
+            f.clear();
+        vector<vector<FineHistogram>> fines(fineInWorkers ? nrOfThreads : 0, workerFines);
+    
+        vector<thread> workers;
+        for (int t = 0; t < nrOfThreads; ++t)
+        {
+            vector<FineHistogram>* fine = fineInWorkers ? &fines[t] : nullptr;
+            shared_ptr<PRNG> prng = t == 0 ? gen.prng : newPRNG();
+            if (lanes)
+            {
+                LaneChunkGenerator g(t == 0 ? lanes : prng->newLanes(), prng->getNrOfBits());
+                vector<SeqAnalyzer> an;
+                if (analyzer)
+                    an.assign(LanePRNG::nrOfLanes, *analyzer);
+                workers.push_back(thread(workLanes, g, an, fine));
+            }
+            else
+            {
+                shared_ptr<SeqAnalyzer> an(analyzer ? new SeqAnalyzer(*analyzer) : nullptr);
+                workers.push_back(thread(work, ChunkGenerator(prng), an, fine));
+            }
+        }
+    
+        shared_ptr<SeqAnalyzer> seqAnalyzer; // the walk of the current sequence
+        for (long64 u = 0; u < nrOfUnits; ++u)
+        {
+            long64 i = u / nrOfSegments;
+            long64 segNr = u % nrOfSegments;
+            if (segNr == 0 && (i + 1) % 100 == 0)
+                fprintf(stderr, "Generator: %lld/%lld\n", i + 1, nrOfStrings);
+            while (true)
+            {
+                vector<ulong64> block;
+                {
+                    unique_lock<mutex> lock(m);
+                    telemetry.time(Telemetry::WRITER_WAIT, [&]() {
+                        produced.wait(lock, [&]() { return !slots[u].blocks.empty() || slots[u].done; });
+                    });
+                    if (slots[u].blocks.empty())
+                        break;
+                    block = move(slots[u].blocks.front());
+                    slots[u].blocks.pop_front();
+                }
+                consumed.notify_all();
+                out->write(block.data(), block.size() * sizeof(ulong64));
+            }
+            if (analyzer)
+            {
+                if (segNr == 0)
+                    seqAnalyzer = slots[u].analyzer;
+                else
+                    seqAnalyzer->addSegment(*slots[u].walk);
+                if (segNr == nrOfSegments - 1)
+                    addResults(*seqAnalyzer, !fineInWorkers);
+            }
+            if (segNr == nrOfSegments - 1)
+                telemetry.addSequence();
+            {
+                lock_guard<mutex> lock(m);
+                slots[u] = SeqSlot();
+                nextToWrite = u + 1;
+                if (stopped)
+                    endUnit = u + 1; // workers finish the units they have taken and quit
+            }
+            consumed.notify_all();
+            if (stopped)
+                break;
+        }
+    
+        for (auto& w : workers)
+            w.join();
+        for (auto& f : fines)
+        {
+            size_t k = 0;
+            for (TestOutputs& test : tests)
+                if (test.fineHistogram)
+                    test.fineHistogram->addCounts(f[k++]);
+        }
+    }
+
+    int nextSeed()
     {
-        return shared_ptr<PRNG>(new RandU());
+        if (seeds)
+            return getNextIntFromFile() + 1000000001;
+        else
+            return defaultSeed++;
     }
-    else if (strcmp(name, "zepsuty") == 0)
+    
+    int getNextIntFromFile()
     {
-        return shared_ptr<PRNG>(new Flawed());
+        int val;
+        fscanf(seeds, "%d", &val);
+        return val;
     }
-	else if(strcmp(name, "FlawedDyck") == 0)
-	{
-		return shared_ptr<PRNG>(new FlawedDyck(log_len));
-	}
-	else if(strcmp(name, "FlawedDyckMT") == 0)
-	{
-		return shared_ptr<PRNG>(new FlawedDyckMT(log_len, step_flawed));
+};
+
+void wrongArgs(int, char** argv)
+{
+        printf("Usage: %s [prng name] [number of strings | path to seeds] [log2 of length >= 6] [nrOfSeeds to skip] [-nolen] [-f step size for FlawedDyckMT] [-stream] [-loglog] "
+               "[-asin pathToFile] [-lil pathToFile] [-cp nrOfCheckPoints] [-t nrOfThreads] [-s nrOfSegments] [-buf output buffer size in KB] [-o pathToContainer] "
+               "[-shard k/N] [-hist pathToHistogram] [-fhist pathToFineHistogram] [-resume] [-stats seconds] [-stop alpha] \n", argv[0]);
+        exit(1);
+}
+
+// the path with "_testName" inserted before its extension, e.g. x.hist -> x_asin.hist
+string withTestName(const char* path, const char* testName)
+{
+    string s = path;
+    size_t slash = s.find_last_of('/');
+    size_t start = slash == string::npos ? 0 : slash + 1;
+    size_t dot = s.find_last_of('.');
+    if (dot == string::npos || dot <= start)
+        dot = s.size();
+    return s.substr(0, dot) + "_" + testName + s.substr(dot);
+}
+
+/**********************************************************************************
+ *                                                                                *
+ *  prngRegistry - the PRNGs known by name. The generators built from an engine   *
+ *                 and a selection of its bits are instantiations of Composed,    *
+ *                 getPRNG only looks up the name and calls make of its entry.    *
+ *                                                                                *
+ **********************************************************************************/
+struct PRNGParams
+{
+    uint32 logLength;   // of a sequence, for FlawedDyck and FlawedDyckMT
+    long64 stepFlawed;  // every stepFlawed-th sequence of FlawedDyckMT is flawed
+    bool bbsMultiBits;
+    bool flawedStreaming;
+};
+
+struct PRNGEntry
+{
+    const char* name;
+    shared_ptr<PRNG> (*make)(const char* name, const PRNGParams& params);
+    bool byPrefix;      // the name is followed by parameters, e.g. BBS_p_q
+};
+
+template <class P>
+shared_ptr<PRNG> makePRNG(const char*, const PRNGParams&)
+{
+    return shared_ptr<PRNG>(new P());
+}
+
+shared_ptr<PRNG> makeFlawedDyck(const char*, const PRNGParams& params)
+{
+    return shared_ptr<PRNG>(new FlawedDyck(params.logLength, params.flawedStreaming));
+}
+
+shared_ptr<PRNG> makeFlawedDyckMT(const char*, const PRNGParams& params)
+{
+    return shared_ptr<PRNG>(new FlawedDyckMT(params.logLength, params.stepFlawed, params.flawedStreaming));
+}
+
+// name == BBS or name == BBS_p_q
+shared_ptr<PRNG> makeBBS(const char* name, const PRNGParams& params)
+{
+	char* p = NULL;
+	char* q = NULL;
+	string primes(name + 3); // strtok modifies the string and getPRNG may be called once per thread
+	if(primes.empty())
+	{ // Default parameters - two 64-bit prime numbers
+		p = (char*) "11234773052181932039";
+		q = (char*) "15755662711309472467";
 	}
-	else if(strncmp(name, "BBS", 3) == 0) // name == BBS or name == BBS_p_q
-	{
-		char* p = NULL;
-		char* q = NULL;
-		if(strlen(name) == 3)
-		{ // Default parameters - two 64-bit prime numbers
-			p = (char*) "11234773052181932039";
-			q = (char*) "15755662711309472467";
-		}
-		else
-		{ 
-			p = strtok(name + 3, "_");
-			if(p != NULL)
-			{
-				q = strtok(NULL, "_");
-			}
-		}
-		if(p != NULL && q != NULL)
+	else
+	{ 
+		p = strtok(&primes[0], "_");
+		if(p != NULL)
 		{
-			return shared_ptr<PRNG>(new BBS64_PRNG(p, q));
+			q = strtok(NULL, "_");
 		}
 	}
+	if(p != NULL && q != NULL)
+	{
+		return shared_ptr<PRNG>(new BBS64_PRNG(p, q, params.bbsMultiBits));
+	}
+	return shared_ptr<PRNG>();
+}
+
+typedef LCGEngine<2147483648ULL, 1103515245, 12345> RandEngine;
+typedef LCGEngine<2147483647, 16807, 0> MinstdEngine;
+typedef LCGEngine<2147483647, 48271, 0> NewMinstdEngine;
+
+const PRNGEntry prngRegistry[] = {
+    {"z_czapy",      makePRNG<Composed<LCGEngine<1000000000, 1234, 3>, 0, 8>>, false},
+    {"Rand",         makePRNG<Composed<RandEngine, 0, 31>>, false},
+    {"Rand0",        makePRNG<Composed<RandEngine, 0, 8>>, false},
+    {"Rand1",        makePRNG<Composed<RandEngine, 8, 8>>, false},
+    {"Rand3",        makePRNG<Composed<RandEngine, 23, 8>>, false},
+    {"Minstd",       makePRNG<Composed<MinstdEngine, 0, 31>>, false},
+    {"Minstd0",      makePRNG<Composed<MinstdEngine, 0, 8>>, false},
+    {"Minstd1",      makePRNG<Composed<MinstdEngine, 8, 8>>, false},
+    {"NewMinstd",    makePRNG<Composed<NewMinstdEngine, 0, 31>>, false},
+    {"NewMinstd0",   makePRNG<Composed<NewMinstdEngine, 0, 8>>, false},
+    {"NewMinstd1",   makePRNG<Composed<NewMinstdEngine, 8, 8>>, false},
+    {"NewMinstd3",   makePRNG<Composed<NewMinstdEngine, 23, 8>>, false},
+    {"CMRG",         makePRNG<Composed<CMRGEngine, 0, 31>>, false},
+    {"CMRG0",        makePRNG<Composed<CMRGEngine, 0, 8>>, false},
+    {"CMRG1",        makePRNG<Composed<CMRGEngine, 8, 8>>, false},
+    {"SBorland",     makePRNG<Composed<BorlandEngine, 7, 8>>, false},  // discard 7 LSBs produced by the PRNG
+    {"C_PRG",        makePRNG<C_PRG>, false},
+    {"SVIS",         makePRNG<Composed<VisualEngine, 7, 8>>, false},   // discard 7 LSBs produced by the PRNG
+    {"Mersenne",     makePRNG<Mersenne>, false},
+    {"RANDU",        makePRNG<RandU>, false},
+    {"zepsuty",      makePRNG<Flawed>, false},
+    {"FlawedDyck",   makeFlawedDyck, false},
+    {"FlawedDyckMT", makeFlawedDyckMT, false},
+    {"BBS",          makeBBS, true},
+};
+
+shared_ptr<PRNG> getPRNG(const char* name, uint32 log_len = 26, long64 step_flawed = 100, bool bbs_multi_bits = false, bool flawed_streaming = false)
+{
+    const PRNGParams params = {log_len, step_flawed, bbs_multi_bits, flawed_streaming};
+    for (const PRNGEntry& entry : prngRegistry)
+    {
+        if (entry.byPrefix ? strncmp(name, entry.name, strlen(entry.name)) == 0 : strcmp(name, entry.name) == 0)
+            return entry.make(name, params);
+    }
     return shared_ptr<PRNG>();
 }
 
-int main(int argc, char** argv)
+// the whole program for the command line argc, argv; tests (testRuns.cpp) call it for several runs
+int prngMain(int argc, char** argv)
 {
+    Telemetry::blockReportSignal(); // a report asked for while the seeds are read is printed when the run starts
     initPow();
     //printPow();
     
@@ -998,55 +3163,175 @@ int main(int argc, char** argv)
 	long64 length = myPow(2LL, logLength);
     long64 skip = 0;
 	long64 step_flawed = 100;
+	bool bbs_multi_bits = false;
+	bool flawed_streaming = false;
 	bool write_data_len = true;
-    if (argc == 5) {
-		if(strcmp(argv[4], "-nolen") == 0) {
+	bool resume = false;
+	char* pathToResults[2] = {NULL, NULL}; // of TEST_ASIN and TEST_LIL
+	int nrOfCheckPoints = 0;
+	int nrOfThreads = 1;
+	int nrOfSegments = 1;
+	size_t outputBufferKB = 4096;
+	char* pathToContainer = NULL;
+	char* pathToHistogram = NULL;
+	char* pathToFineHistogram = NULL;
+	int shardNr = 1;
+	int nrOfShards = 1;
+	int reportInterval = 60;
+	double stopAlpha = 0;
+	for (int i = 4; i < argc; ++i) {
+		if (strcmp(argv[i], "-nolen") == 0) {
 			write_data_len = false;
 		}
-		else {
-			skip = atoi(argv[4]);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			step_flawed = atoi(argv[++i]);
 		}
-    }
-	else if (argc == 6) {
-		if(strcmp(argv[4], "-f") == 0) {
-			step_flawed = atoi(argv[5]);
+		else if (strcmp(argv[i], "-stream") == 0) {
+			flawed_streaming = true;
 		}
-		else {
-			skip = atoi(argv[4]);
-			if(strcmp(argv[5], "-nolen") == 0) {
-				write_data_len = false;
+		else if (strcmp(argv[i], "-loglog") == 0) {
+			bbs_multi_bits = true;
+		}
+		else if ((strcmp(argv[i], "-asin") == 0 || strcmp(argv[i], "-lil") == 0) && i + 1 < argc) {
+			TestType type = strcmp(argv[i], "-asin") == 0 ? TEST_ASIN : TEST_LIL;
+			if (pathToResults[type]) {
+				fprintf(stderr, "Each of -asin, -lil can be given once\n");
+				wrongArgs(argc, argv);
 			}
+			pathToResults[type] = argv[++i];
 		}
-		
-	}
-	else if (argc == 7) {
-		if(strcmp(argv[4], "-nolen") == 0) {
-			write_data_len = false;
+		else if (strcmp(argv[i], "-cp") == 0 && i + 1 < argc) {
+			nrOfCheckPoints = atoi(argv[++i]);
+			if (nrOfCheckPoints < 0 || nrOfCheckPoints > (int) logLength) {
+				wrongArgs(argc, argv);
+			}
 		}
-		else {
-			skip = atoi(argv[4]);
+		else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+			nrOfThreads = atoi(argv[++i]);
+			if (nrOfThreads <= 0) {
+				nrOfThreads = max(1u, thread::hardware_concurrency());
+			}
 		}
-		if(strcmp(argv[5], "-f") == 0) {
-			step_flawed = atoi(argv[6]);
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			nrOfSegments = atoi(argv[++i]);
+			if (nrOfSegments <= 0 || (nrOfSegments & (nrOfSegments - 1)) != 0 || length / nrOfSegments < 64) {
+				fprintf(stderr, "Number of segments has to be a power of 2, at most 2^(log2 of length - 6)\n");
+				wrongArgs(argc, argv);
+				exit(1);
+			}
 		}
-	}
-	else if (argc > 7) {
-		skip = atoi(argv[4]);
-		if(strcmp(argv[5], "-nolen") == 0) {
-			write_data_len = false;
+		else if (strcmp(argv[i], "-shard") == 0 && i + 1 < argc) {
+			if (sscanf(argv[++i], "%d/%d", &shardNr, &nrOfShards) != 2 || shardNr < 1 || shardNr > nrOfShards) {
+				fprintf(stderr, "Shard has to be given as k/N with 1 <= k <= N\n");
+				wrongArgs(argc, argv);
+			}
+		}
+		else if (strcmp(argv[i], "-resume") == 0) {
+			resume = true;
 		}
-		if(strcmp(argv[6], "-f") == 0) {
-				step_flawed = atoi(argv[7]);
+		else if (strcmp(argv[i], "-stats") == 0 && i + 1 < argc) {
+			reportInterval = atoi(argv[++i]);
+			if (reportInterval < 0) {
+				wrongArgs(argc, argv);
+			}
+		}
+		else if (strcmp(argv[i], "-stop") == 0 && i + 1 < argc) {
+			stopAlpha = atof(argv[++i]);
+			if (stopAlpha <= 0 || stopAlpha >= 1) {
+				fprintf(stderr, "The level of the sequential test has to be in (0, 1)\n");
+				wrongArgs(argc, argv);
+			}
+		}
+		else if (strcmp(argv[i], "-hist") == 0 && i + 1 < argc) {
+			pathToHistogram = argv[++i];
+		}
+		else if (strcmp(argv[i], "-fhist") == 0 && i + 1 < argc) {
+			pathToFineHistogram = argv[++i];
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			pathToContainer = argv[++i];
+		}
+		else if (strcmp(argv[i], "-buf") == 0 && i + 1 < argc) {
+			int kb = atoi(argv[++i]);
+			if (kb <= 0) {
+				wrongArgs(argc, argv);
+			}
+			outputBufferKB = kb;
+		}
+		else if (i == 4) {
+			skip = atoi(argv[i]);
+		}
+		else {
+			wrongArgs(argc, argv);
 		}
 	}
 	
-	shared_ptr<PRNG> prng = getPRNG(argv[1], logLength, step_flawed);
+	const int nrOfTests = (pathToResults[TEST_ASIN] != NULL) + (pathToResults[TEST_LIL] != NULL);
+	if (pathToContainer && nrOfTests > 0) {
+		fprintf(stderr, "-o cannot be given with -asin, -lil\n");
+		wrongArgs(argc, argv);
+	}
+	if ((pathToHistogram || pathToFineHistogram || resume || stopAlpha > 0) && nrOfTests == 0) {
+		fprintf(stderr, "-hist, -fhist, -resume and -stop require -asin or -lil\n");
+		wrongArgs(argc, argv);
+	}
+	
+	shared_ptr<PRNG> prng = getPRNG(argv[1], logLength, step_flawed, bbs_multi_bits, flawed_streaming);
     if (!prng)
     {
         printf("Unknown prng: %s\n", argv[1]);
         exit(1);
     }
+    // options changing the output of the PRNG are part of its name, so that
+    // results, histograms and containers of different outputs are not mixed
+    string prngName = argv[1];
+    if (step_flawed != 100)
+        prngName += " -f " + to_string(step_flawed);
+    if (bbs_multi_bits)
+        prngName += " -loglog";
+    if (flawed_streaming)
+        prngName += " -stream";
     GeneratorInvoker gi(prng, skip);
+    if (nrOfTests > 0)
+    {
+        shared_ptr<SeqAnalyzer> analyzer(new SeqAnalyzer(nrOfCheckPoints, logLength));
+        gi.setAnalyzer(analyzer);
+        for (TestType type : {TEST_ASIN, TEST_LIL})
+        {
+            if (!pathToResults[type])
+                continue;
+            // with both tests the histograms of a test get its name, the level of the sequential test is shared
+            const char* testName = type == TEST_ASIN ? "asin" : "lil";
+            GeneratorInvoker::TestOutputs test;
+            test.type = type;
+            test.results.reset(new ResultWriter(pathToResults[type], *analyzer, resume));
+            if (pathToHistogram)
+            {
+                test.histogram.reset(new ResultHistogram(type, *analyzer, logLength, prngName));
+                test.pathToHistogram = nrOfTests > 1 ? withTestName(pathToHistogram, testName) : pathToHistogram;
+            }
+            if (pathToFineHistogram)
+            {
+                test.fineHistogram.reset(new FineHistogram(type, *analyzer, logLength, prngName));
+                test.pathToFineHistogram = nrOfTests > 1 ? withTestName(pathToFineHistogram, testName) : pathToFineHistogram;
+            }
+            if (stopAlpha > 0)
+                test.sequentialTest.reset(new SequentialTest(type, *analyzer, logLength, prngName, stopAlpha / nrOfTests));
+            gi.addTest(test);
+        }
+    }
+    if (nrOfThreads > 1)
+    {
+        char* name = argv[1];
+        gi.setThreads(nrOfThreads, [=]() { return getPRNG(name, logLength, step_flawed, bbs_multi_bits, flawed_streaming); });
+    }
+    gi.setSegments(nrOfSegments);
+    gi.setShard(shardNr, nrOfShards);
+    gi.setOutputBufferSize(outputBufferKB * 1024);
+    gi.setReportInterval(reportInterval);
+    gi.setPRNGName(prngName);
+    if (pathToContainer)
+        gi.setContainer(pathToContainer);
     if (nrOfStrings <= 0)
     {
         gi.setPathToSeeds(argv[2]);
@@ -1058,3 +3343,10 @@ int main(int argc, char** argv)
     }
     return 0;
 }
+
+#ifndef PRNG_NO_MAIN // benchmark.cpp and the tests have their own main
+int main(int argc, char** argv)
+{
+    return prngMain(argc, argv);
+}
+#endif
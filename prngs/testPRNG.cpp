@@ -0,0 +1,727 @@
+#define PRNG_NO_MAIN
+#include "prng.cpp"
+
+/**********************************************************************************
+ *                                                                                *
+ *  testPRNG - checks of the generators of prng.cpp and of the walk of           *
+ *             SeqAnalyzer against plain ways of computing the same outputs       *
+ *                                                                                *
+ *    - registry: getPRNG gives the PRNGs of all names known before prngRegistry *
+ *      (BBS also with its parameters, BBS_p_q) with their numbers of bits and    *
+ *      nothing for other names; the bytes of an engine (e.g. Rand1) are bits of  *
+ *      its whole output (Rand)                                                   *
+ *    - bulk: nextInts equals as many calls of nextInt, for every PRNG of         *
+ *      prngRegistry and blocks of any length                                     *
+ *                                                                                *
+ *    - packing: the words of ChunkGenerator (and of the packers for outputs of   *
+ *      any number of bits) equal the outputs written bit by bit, output k at     *
+ *      bits k*W ... k*W + W - 1 of the sequence                                  *
+ *                                                                                *
+ *    - lanes: every lane of the multi-lane engine of a PRNG (newLanes) and of    *
+ *      LaneChunkGenerator equals the PRNG seeded with the seed of the lane       *
+ *                                                                                *
+ *    - jump: jump(k) skips exactly k outputs, for every PRNG, and ChunkGenerator *
+ *      started at a bit of a sequence (a segment of -s) continues it             *
+ *                                                                                *
+ *    - MT19937_64: outputs, bulk outputs and long jumps (over many twists of    *
+ *      the state) equal those of std::mt19937_64 and its discard                 *
+ *                                                                                *
+ *    - walk: the balance and the time above the line at the check points of     *
+ *      SeqAnalyzer, for words read at once and for WalkSegments (-s), equal      *
+ *      those of a walk bit by bit, also for walks far from the line              *
+ *                                                                                *
+ *    - BBS: Montgomery128 multiplies as modular multiplication by doubling, also *
+ *      for moduli close to 2^128, and the BBS outputs (also with -loglog) equal  *
+ *      those of squarings computed so; its jumps (by the Chinese Remainder       *
+ *      Theorem) skip exactly as many outputs, also long jumps                    *
+ *                                                                                *
+ *    - FlawedPath: PackedBits changes bits as vector<bool> does, and the paths   *
+ *      (of both algorithms) are those of the former implementation on            *
+ *      vector<bool> (hashes of its paths); the paths of generateBitSequence      *
+ *      spend half of the time above the line [P1]                                *
+ *      (also of every n <= 300, with the subpaths and their lowest levels at     *
+ *      all positions within the words searched by firstLowestLevel)              *
+ *                                                                                *
+ *    - streaming: paths streamed in bounded memory (startStream, nextStreamWord) *
+ *      have the same distribution as those of generateBitSequence2: the          *
+ *      frequencies of ones at every position and of the times above the line    *
+ *      of many paths of both agree within 5 standard deviations                  *
+ *                                                                                *
+ *    - C_PRG: the outputs equal those of rand() of the C library (glibc) after   *
+ *      srand with the same seed, also for seeds 0 and >= 2^31                    *
+ *                                                                                *
+ *  Prints OK or FAILED for every check, returns the number of failed checks.     *
+ *                                                                                *
+ **********************************************************************************/
+static int nrOfFailed = 0;
+
+// seeds of the sequences of a check, consecutive as the default seeds of a run (the 7th one flawed)
+static const uint32 firstSeed = 112358;
+static const int nrOfSeeds = 8;
+
+// a PRNG of prngRegistry, made as by a run of sequences of length 2^12 in which every 7th one is flawed
+static shared_ptr<PRNG> newPRNG(const char* name) {
+	return getPRNG(name, 12, 7);
+}
+
+static void check(const string& name, bool ok) {
+	printf("%s: %s\n", name.c_str(), ok ? "OK" : "FAILED");
+	nrOfFailed += !ok;
+}
+
+// the next n outputs of prng by calls of nextInt
+static vector<ulong64> nextOutputs(PRNG& prng, size_t n) {
+	vector<ulong64> res(n);
+	for (size_t i = 0; i < n; ++i) {
+		res[i] = prng.nextInt();
+	}
+	return res;
+}
+
+// a PRNG for every name known before prngRegistry, with its number of bits, and none for other names
+static bool registryHasAllNames() {
+	const struct { const char* name; uint32 nrOfBits; } known[] = {
+		{"z_czapy", 8}, {"Rand", 31}, {"Rand0", 8}, {"Rand1", 8}, {"Rand3", 8}, {"Minstd", 31}, {"Minstd0", 8},
+		{"Minstd1", 8}, {"NewMinstd", 31}, {"NewMinstd0", 8}, {"NewMinstd1", 8}, {"NewMinstd3", 8}, {"CMRG", 31},
+		{"CMRG0", 8}, {"CMRG1", 8}, {"SBorland", 8}, {"C_PRG", 31}, {"SVIS", 8}, {"Mersenne", 64}, {"RANDU", 31},
+		{"zepsuty", 64}, {"FlawedDyck", 64}, {"FlawedDyckMT", 64}, {"BBS", 64}, {"BBS_2147483647_4294967291", 64},
+	};
+	for (const auto& k : known) {
+		shared_ptr<PRNG> prng = newPRNG(k.name);
+		if (!prng || prng->getNrOfBits() != k.nrOfBits) {
+			return false;
+		}
+	}
+	for (const char* name : {"", "Mersenne2", "Mersenn", "mersenne", "Rand2", "BBS_2147483647", "FlawedDyck "}) {
+		if (newPRNG(name)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// the outputs of byteName are the bits shift..shift + 7 of those of name (the same engine)
+static bool bytesOfEngine(const char* name, const char* byteName, int shift) {
+	shared_ptr<PRNG> prng = newPRNG(name);
+	shared_ptr<PRNG> bytes = newPRNG(byteName);
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		prng->setSeed(firstSeed + s);
+		bytes->setSeed(firstSeed + s);
+		for (int i = 0; i < 1000; ++i) {
+			if (bytes->nextInt() != ((prng->nextInt() >> shift) & 255)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// nextInts in blocks of growing lengths (also 0 and 1) equals nextInt
+static bool bulkEqualsSingle(const char* name) {
+	shared_ptr<PRNG> single = newPRNG(name);
+	shared_ptr<PRNG> bulk = newPRNG(name);
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		single->setSeed(firstSeed + s);
+		bulk->setSeed(firstSeed + s);
+		for (size_t n : {0, 1, 2, 7, 64, 311, 313, 1000}) {
+			vector<ulong64> buf(n);
+			bulk->nextInts(buf.data(), n);
+			if (buf != nextOutputs(*single, n)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// the first nrOfWords words of outputs of nrOfBits bits written bit by bit
+static vector<ulong64> packedBitByBit(const vector<ulong64>& outputs, uint32 nrOfBits, size_t nrOfWords) {
+	vector<ulong64> words(nrOfWords);
+	for (size_t pos = 0; pos < 64 * nrOfWords; ++pos) {
+		words[pos / 64] |= ((outputs[pos / nrOfBits] >> (pos % nrOfBits)) & 1) << (pos % 64);
+	}
+	return words;
+}
+
+// the packer of getPacker for a block and packTail for fewer words pack as bit by bit, for any number of bits
+static bool packersEqualBitByBit() {
+	MT19937_64 eng;
+	for (uint32 nrOfBits = 1; nrOfBits <= 64; ++nrOfBits) {
+		PackFun pack;
+		size_t blockWords;
+		getPacker(nrOfBits, pack, blockWords);
+		vector<ulong64> outputs(blockWords * 64 / nrOfBits + 1);
+		for (ulong64& r : outputs) {
+			r = eng() & pow2m1[nrOfBits];
+		}
+		vector<ulong64> words(blockWords);
+		pack(outputs.data(), words.data(), blockWords, nrOfBits);
+		if (words != packedBitByBit(outputs, nrOfBits, blockWords)) {
+			return false;
+		}
+		for (size_t nrOfWords : {(size_t) 1, (size_t) 3, blockWords - 1}) {
+			vector<ulong64> tail(nrOfWords);
+			packTail(outputs.data(), tail.data(), nrOfWords, nrOfBits);
+			if (tail != packedBitByBit(outputs, nrOfBits, nrOfWords)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// ChunkGenerator packs the outputs of consecutive sequences of length 2^logLength as bit by bit
+static bool chunksEqualBitByBit(const char* name, uint32 logLength) {
+	shared_ptr<PRNG> prng = getPRNG(name, logLength, 7);
+	shared_ptr<PRNG> single = getPRNG(name, logLength, 7);
+	ChunkGenerator gen(prng);
+	const size_t nrOfWords = (1ULL << logLength) / 64;
+	const uint32 nrOfBits = single->getNrOfBits();
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		prng->setSeed(firstSeed + s);
+		single->setSeed(firstSeed + s);
+		gen.reset(1ULL << logLength);
+		vector<ulong64> words(nrOfWords);
+		for (ulong64& word : words) {
+			word = gen.nextChunk();
+		}
+		if (words != packedBitByBit(nextOutputs(*single, (64 * nrOfWords + nrOfBits - 1) / nrOfBits), nrOfBits, nrOfWords)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// the lanes (if the PRNG has them) output and pack for every seed what the PRNG does, also for seeds above the moduli
+static bool lanesEqualSingleSeeds(const char* name) {
+	shared_ptr<PRNG> single = newPRNG(name);
+	shared_ptr<LanePRNG> lanes = single->newLanes();
+	if (!lanes) {
+		return true;
+	}
+	const uint32 seeds[LanePRNG::nrOfLanes] = {firstSeed, firstSeed + 1, 1, 2, 2147483646, 2147483647, 2147483648u, 4294967295u};
+	const size_t n = 3000;
+	vector<ulong64> out(n * LanePRNG::nrOfLanes);
+	lanes->setSeeds(seeds);
+	lanes->nextInts(out.data(), 1);
+	lanes->nextInts(out.data() + LanePRNG::nrOfLanes, n - 1);
+	for (int l = 0; l < LanePRNG::nrOfLanes; ++l) {
+		single->setSeed(seeds[l]);
+		for (size_t i = 0; i < n; ++i) {
+			if (out[i * LanePRNG::nrOfLanes + l] != single->nextInt()) {
+				return false;
+			}
+		}
+	}
+	const uint32 nrOfBits = single->getNrOfBits();
+	for (ulong64 seqLen : {1ULL << 6, 1ULL << 12, 1ULL << 17}) {
+		LaneChunkGenerator laneGen(single->newLanes(), nrOfBits);
+		laneGen.reset(seeds, seqLen);
+		vector<vector<ulong64>> words(LanePRNG::nrOfLanes);
+		for (size_t len; (len = laneGen.nextBlock()) > 0; ) {
+			for (int l = 0; l < LanePRNG::nrOfLanes; ++l) {
+				words[l].insert(words[l].end(), laneGen.getWords(l), laneGen.getWords(l) + len);
+			}
+		}
+		for (int l = 0; l < LanePRNG::nrOfLanes; ++l) {
+			single->setSeed(seeds[l]);
+			ChunkGenerator gen(single);
+			gen.reset(seqLen);
+			if (words[l].size() != seqLen / 64) {
+				return false;
+			}
+			for (ulong64 word : words[l]) {
+				if (word != gen.nextChunk()) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// after jump(k) the PRNG outputs what it does after k calls of nextInt, for jumps by nrsOfOutputs one after another
+static bool jumpEqualsSequential(const char* name, const vector<ulong64>& nrsOfOutputs) {
+	shared_ptr<PRNG> jumping = newPRNG(name);
+	shared_ptr<PRNG> sequential = newPRNG(name);
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		jumping->setSeed(firstSeed + s);
+		sequential->setSeed(firstSeed + s);
+		for (ulong64 k : nrsOfOutputs) {
+			jumping->jump(k);
+			for (ulong64 i = 0; i < k; ++i) {
+				sequential->nextInt();
+			}
+			if (nextOutputs(*jumping, 5) != nextOutputs(*sequential, 5)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// ChunkGenerator reset at startBit of a sequence of length 2^logLength generates its words from startBit on
+static bool segmentEqualsSequence(const char* name, uint32 logLength, const vector<ulong64>& startBits) {
+	shared_ptr<PRNG> prng = getPRNG(name, logLength, 7);
+	ChunkGenerator gen(prng);
+	const ulong64 seqLen = 1ULL << logLength;
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		// the number of the seed set again for every segment, as by GeneratorInvoker
+		prng->setSeedNr(s);
+		prng->setSeed(firstSeed + s);
+		gen.reset(seqLen);
+		vector<ulong64> words(seqLen / 64);
+		for (ulong64& word : words) {
+			word = gen.nextChunk();
+		}
+		for (ulong64 startBit : startBits) {
+			prng->setSeedNr(s);
+			prng->setSeed(firstSeed + s);
+			gen.reset(seqLen - startBit, startBit);
+			for (size_t w = startBit / 64; w < words.size(); ++w) {
+				if (gen.nextChunk() != words[w]) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// Mersenne (MT19937_64) after jumps by nrsOfOutputs one after another outputs as std::mt19937_64 does, single and in bulk
+static bool mersenneEqualsStd(const vector<ulong64>& nrsOfOutputs) {
+	shared_ptr<PRNG> mersenne = newPRNG("Mersenne");
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		std::mt19937_64 reference(firstSeed + s);
+		mersenne->setSeed(firstSeed + s);
+		for (ulong64 k : nrsOfOutputs) {
+			mersenne->jump(k);
+			reference.discard(k);
+			vector<ulong64> buf(700);
+			mersenne->nextInts(buf.data(), buf.size());
+			for (ulong64 r : buf) {
+				if (r != reference()) {
+					return false;
+				}
+			}
+			if (mersenne->nextInt() != reference()) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// words of a sequence of length 2^logLength: random ones mixed with long runs of ones and of zeros
+static vector<ulong64> walkWords(uint32 logLength, MT19937_64& eng) {
+	vector<ulong64> words((1ULL << logLength) / 64);
+	for (size_t w = 0; w < words.size(); ) {
+		const ulong64 r = eng();
+		const size_t len = min<size_t>(words.size() - w, 1 + r % 8);
+		for (size_t i = 0; i < len; ++i, ++w) {
+			words[w] = (r >> 8) % 3 == 0 ? eng() : ((r >> 8) % 3 == 1 ? ~0ULL : eng() & eng() & eng());
+		}
+	}
+	return words;
+}
+
+// SeqAnalyzer with nrOfCheckPoints check points, reading a sequence as words or (after the first one) as
+// nrOfSegments WalkSegments, records the same balance and time above the line as a walk bit by bit
+static bool walkEqualsBitByBit(uint32 logLength, int nrOfCheckPoints, int nrOfSegments) {
+	MT19937_64 eng;
+	SeqAnalyzer analyzer(nrOfCheckPoints, logLength);
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		eng.seed(firstSeed + s);
+		const vector<ulong64> words = walkWords(logLength, eng);
+		analyzer.reset();
+		const size_t segmentWords = words.size() / nrOfSegments;
+		for (int k = 0; k < nrOfSegments; ++k) {
+			WalkSegment segment;
+			for (size_t w = k * segmentWords; w < (k + 1) * segmentWords; ++w) {
+				if (k == 0) {
+					analyzer.addWord(words[w]);
+				}
+				else {
+					segment.addWord(words[w]);
+				}
+			}
+			if (k > 0) {
+				analyzer.addSegment(segment);
+			}
+		}
+		long64 balance = 0, above = 0, pos = 0;
+		int cp = 0;
+		for (ulong64 word : words) {
+			for (int b = 0; b < 64; ++b) {
+				const long64 prevBalance = balance;
+				balance += ((word >> b) & 1) ? 1 : -1;
+				above += prevBalance > 0 || balance > 0;
+				if (++pos == analyzer.getCheckPoint(cp)) {
+					if (analyzer.getBalance(cp) != balance || analyzer.getAboveTheLine(cp) != above) {
+						return false;
+					}
+					cp += cp + 1 < analyzer.getNrOfCheckPoints();
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// a * b mod m, by doubling
+static ulong128 mulModByDoubling(ulong128 a, ulong128 b, ulong128 m) {
+	ulong128 res = 0;
+	for (a %= m; b; b >>= 1) {
+		if (b & 1) {
+			res = res >= m - a ? res - (m - a) : res + a;
+		}
+		a = a >= m - a ? a - (m - a) : a + a;
+	}
+	return res;
+}
+
+// Montgomery128 modulo n multiplies numbers smaller than n (random ones and the extreme ones) as mulModByDoubling
+static bool montgomeryEqualsDoubling(ulong128 n) {
+	MT19937_64 eng;
+	const Montgomery128 mont(n);
+	for (int i = 0; i < 3000; ++i) {
+		ulong128 a = ((ulong128) eng() << 64 | eng()) % n;
+		ulong128 b = ((ulong128) eng() << 64 | eng()) % n;
+		if (i < 4) {
+			a = i & 1 ? n - 1 : 0;
+			b = i & 2 ? n - 1 : 1;
+		}
+		if (mont.fromMont(mont.mul(mont.toMont(a), mont.toMont(b))) != mulModByDoubling(a, b, n) || mont.fromMont(mont.toMont(a)) != a) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// BBS_p_q (p, q < 2^64) outputs the lowest bits (floor(log2(log2 n)) of them with multiBits) of squarings modulo n = p*q,
+// the first ones most significant in an output
+static bool bbsEqualsSquarings(ulong64 p, ulong64 q, bool multiBits) {
+	const string name = "BBS_" + to_string(p) + "_" + to_string(q);
+	shared_ptr<PRNG> bbs = getPRNG(name.c_str(), 12, 7, multiBits);
+	const ulong128 n = (ulong128) p * q;
+	uint32 bitsOfN = 0;
+	while (bitsOfN < 128 && n >> bitsOfN) {
+		++bitsOfN;
+	}
+	uint32 bitsPerSquaring = 1;
+	while (multiBits && 1u << (bitsPerSquaring + 1) <= bitsOfN - 1) {
+		++bitsPerSquaring;
+	}
+	bitsPerSquaring = multiBits ? bitsPerSquaring : 1;
+	const uint32 nrOfBits = 64 / bitsPerSquaring * bitsPerSquaring;
+	if (bbs->getNrOfBits() != nrOfBits) {
+		return false;
+	}
+	for (int s = 0; s < nrOfSeeds; ++s) {
+		bbs->setSeed(firstSeed + s);
+		ulong128 x = firstSeed + s;
+		for (int i = 0; i < 100; ++i) {
+			ulong64 r = 0;
+			for (uint32 b = 0; b < nrOfBits; b += bitsPerSquaring) {
+				x = mulModByDoubling(x, x, n);
+				r = (r << bitsPerSquaring) | ((ulong64) x & pow2m1[bitsPerSquaring]);
+			}
+			if (bbs->nextInt() != r) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// BBS_p_q after jumps by nrsOfOutputs one after another outputs what it does after as many calls of nextInt
+static bool bbsJumpEqualsSequential(ulong64 p, ulong64 q, bool multiBits, const vector<ulong64>& nrsOfOutputs) {
+	const string name = "BBS_" + to_string(p) + "_" + to_string(q);
+	shared_ptr<PRNG> jumping = getPRNG(name.c_str(), 12, 7, multiBits);
+	shared_ptr<PRNG> sequential = getPRNG(name.c_str(), 12, 7, multiBits);
+	if (!jumping->canJump()) {
+		return false;
+	}
+	for (int s = 0; s < 2; ++s) {
+		jumping->setSeed(firstSeed + s);
+		sequential->setSeed(firstSeed + s);
+		for (ulong64 k : nrsOfOutputs) {
+			jumping->jump(k);
+			for (ulong64 i = 0; i < k; ++i) {
+				sequential->nextInt();
+			}
+			if (nextOutputs(*jumping, 5) != nextOutputs(*sequential, 5)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// random changes of PackedBits (of a copy of another one too) leave the same bits as in vector<bool>
+static bool packedBitsEqualVector() {
+	MT19937_64 eng;
+	const int64 size = 1000;
+	PackedBits bits, other;
+	vector<bool> model(size, true), otherModel(size);
+	bits.assign(size, true);
+	other.assign(size, false);
+	for (int64 i = 0; i < size; ++i) {
+		if (eng() & 1) {
+			other.flip(i);
+			otherModel[i] = !otherModel[i];
+		}
+	}
+	for (int op = 0; op < 20000; ++op) {
+		const ulong64 r = eng();
+		const int64 len = (int64) model.size();
+		int64 begin = eng() % len;
+		int64 end = begin + eng() % (len - begin + 1);
+		switch (r % 6) {
+			case 0:
+				bits.flip(begin);
+				model[begin] = !model[begin];
+				break;
+			case 1: {
+				const int count = 1 + eng() % min<int64>(64, len - begin);
+				const ulong64 w = eng();
+				bits.setWord(begin, w, count);
+				for (int j = 0; j < count; ++j) {
+					model[begin + j] = (w >> (63 - j)) & 1;
+				}
+				break;
+			}
+			case 2:
+				bits.fill(begin, end, r & 8);
+				std::fill(model.begin() + begin, model.begin() + end, (bool) (r & 8));
+				break;
+			case 3:
+				bits.complement(begin, end);
+				for (int64 i = begin; i < end; ++i) {
+					model[i] = !model[i];
+				}
+				break;
+			case 4: {
+				// from the other one, or from a range of this one before or after the destination
+				const bool self = r & 8;
+				const int64 dst = self ? (begin + end) / 2 : eng() % (len - (end - begin) + 1);
+				if (self && end - begin > 0 && (dst - begin) * 2 > end - begin) {
+					end = begin + (dst - begin);
+				}
+				if (self && (dst < end && dst + (end - begin) > begin)) {
+					break;
+				}
+				const vector<bool> src = self ? model : otherModel;
+				bits.copy(self ? bits : other, begin, end, dst);
+				std::copy(src.begin() + begin, src.begin() + end, model.begin() + dst);
+				break;
+			}
+			default:
+				if (len > 64) {
+					bits.popBack();
+					model.pop_back();
+				}
+		}
+		if (bits.size() != (int64) model.size()) {
+			return false;
+		}
+		for (int64 i = 0; i < bits.size(); ++i) {
+			if (bits.get(i) != model[i]) {
+				return false;
+			}
+		}
+		const int64 i = eng() % (bits.size() - 63);
+		ulong64 w = 0;
+		for (int j = 0; j < 64; ++j) {
+			w = (w << 1) | model[i + j];
+		}
+		if (bits.getWord(i) != w) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// FNV-1a of the bits of a path, continuing hash h
+static ulong64 hashOfPath(const PackedBits& path, ulong64 h) {
+	for (int64 i = 0; i < path.size(); ++i) {
+		h = (h ^ (path.get(i) ? 1 : 0) ^ 0x100) * 1099511628211ULL;
+	}
+	return h;
+}
+
+static const ulong64 hashBasis = 14695981039346656037ULL;
+
+// a path of 4n bits of the algorithm (1 - generateBitSequence, 2 - generateBitSequence2) with the hash of the
+// path of the former implementation; the first algorithm spends 2n steps above the line (the second one does
+// not keep [P1] exactly, neither did the former implementation)
+static bool flawedPathEquals(int algorithm, int64 n, int64 seed, ulong64 hash) {
+	FlawedPath fp;
+	const PackedBits& path = *(algorithm == 1 ? fp.generateBitSequence(n, seed) : fp.generateBitSequence2(n, seed));
+	long64 balance = 0, above = 0;
+	for (int64 i = 0; i < path.size(); ++i) {
+		const long64 prevBalance = balance;
+		balance += path.get(i) ? 1 : -1;
+		above += prevBalance > 0 || balance > 0;
+	}
+	return path.size() == 4 * n && (algorithm == 2 || above == 2 * n) && hashOfPath(path, hashBasis) == hash;
+}
+
+// the paths of the algorithm for every n <= 300 (the seed n) with the hash of those of the former implementation
+static bool shortFlawedPathsEqual(int algorithm, ulong64 hash) {
+	FlawedPath fp;
+	ulong64 h = hashBasis;
+	for (int64 n = 1; n <= 300; ++n) {
+		h = hashOfPath(*(algorithm == 1 ? fp.generateBitSequence(n, n) : fp.generateBitSequence2(n, n)), h);
+	}
+	return h == hash;
+}
+
+// paths of 4n bits (n a multiple of 16) for nrOfPaths seeds, generated by generateBitSequence2 and streamed,
+// have the same frequencies of ones at every position and of the times above the line
+static bool streamEqualsInDistribution(int64 n, int nrOfPaths) {
+	FlawedPath fp;
+	vector<long64> ones[2], aboveCounts[2];
+	for (int streamed = 0; streamed < 2; ++streamed) {
+		ones[streamed].assign(4 * n, 0);
+		aboveCounts[streamed].assign(4 * n + 1, 0);
+		for (int s = 0; s < nrOfPaths; ++s) {
+			vector<bool> path(4 * n);
+			if (streamed) {
+				fp.startStream(n, firstSeed + s);
+				for (int64 w = 0; w < 4 * n / 64; ++w) {
+					if (fp.streamEnded()) {
+						return false;
+					}
+					const ulong64 word = fp.nextStreamWord();
+					for (int j = 0; j < 64; ++j) {
+						path[64 * w + j] = (word >> (63 - j)) & 1;
+					}
+				}
+				if (!fp.streamEnded()) {
+					return false;
+				}
+			}
+			else {
+				const PackedBits& bits = *fp.generateBitSequence2(n, firstSeed + s);
+				for (int64 i = 0; i < 4 * n; ++i) {
+					path[i] = bits.get(i);
+				}
+			}
+			long64 balance = 0, above = 0;
+			for (int64 i = 0; i < 4 * n; ++i) {
+				const long64 prevBalance = balance;
+				balance += path[i] ? 1 : -1;
+				above += prevBalance > 0 || balance > 0;
+				ones[streamed][i] += path[i];
+			}
+			++aboveCounts[streamed][above];
+		}
+	}
+	auto agree = [](const vector<long64>& a, const vector<long64>& b) {
+		for (size_t i = 0; i < a.size(); ++i) {
+			if (fabs(a[i] - b[i]) > 5 * sqrt(a[i] + b[i]) + 5) {
+				return false;
+			}
+		}
+		return true;
+	};
+	return agree(ones[0], ones[1]) && agree(aboveCounts[0], aboveCounts[1]);
+}
+
+#ifdef __GLIBC__
+// C_PRG outputs for every seed what rand() does after srand(seed)
+static bool cPRGEqualsRand() {
+	shared_ptr<PRNG> prng = newPRNG("C_PRG");
+	for (uint32 seed : {0u, 1u, firstSeed, 2147483647u, 2147483648u, 4294967295u}) {
+		prng->setSeed(seed);
+		srand(seed);
+		for (int i = 0; i < 3000; ++i) {
+			if (prng->nextInt() != (ulong64) rand()) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+#endif
+
+int main() {
+	initPow();
+
+	check("registry", registryHasAllNames());
+	const struct { const char* name; const char* byteName; int shift; } bytes[] = {
+		{"Rand", "Rand0", 0}, {"Rand", "Rand1", 8}, {"Rand", "Rand3", 23}, {"Minstd", "Minstd0", 0}, {"Minstd", "Minstd1", 8},
+		{"NewMinstd", "NewMinstd0", 0}, {"NewMinstd", "NewMinstd1", 8}, {"NewMinstd", "NewMinstd3", 23},
+		{"CMRG", "CMRG0", 0}, {"CMRG", "CMRG1", 8},
+	};
+	for (const auto& b : bytes) {
+		check(string("registry ") + b.byteName + " of " + b.name, bytesOfEngine(b.name, b.byteName, b.shift));
+	}
+
+	for (const PRNGEntry& entry : prngRegistry) {
+		check(string("bulk ") + entry.name, bulkEqualsSingle(entry.name));
+	}
+
+	check("packing, all numbers of bits", packersEqualBitByBit());
+	for (const PRNGEntry& entry : prngRegistry) {
+		for (uint32 logLength : {6, 12, 17}) {
+			check(string("packing ") + entry.name + ", length 2^" + to_string(logLength), chunksEqualBitByBit(entry.name, logLength));
+		}
+	}
+
+	for (const PRNGEntry& entry : prngRegistry) {
+		if (newPRNG(entry.name)->newLanes()) {
+			check(string("lanes ") + entry.name, lanesEqualSingleSeeds(entry.name));
+		}
+	}
+
+	for (const PRNGEntry& entry : prngRegistry) {
+		check(string("jump ") + entry.name, jumpEqualsSequential(entry.name, {0, 1, 2, 30, 1000, 4097}));
+		check(string("jump ") + entry.name + ", segments", segmentEqualsSequence(entry.name, 14, {64, 1024, 4096, 8192, 12288}));
+	}
+
+	check("MT19937_64", mersenneEqualsStd({0, 1, 311, 312, 313, 624 * 1000 + 5}));
+	check("MT19937_64, jumps by millions", mersenneEqualsStd({1000000, 3000001}));
+
+	check("walk, length 2^6", walkEqualsBitByBit(6, 0, 1));
+	check("walk, length 2^14, 8 check points", walkEqualsBitByBit(14, 8, 1));
+	check("walk, length 2^16, 3 check points, 8 segments", walkEqualsBitByBit(16, 3, 8));
+	check("walk, length 2^12, 6 check points, 64 segments", walkEqualsBitByBit(12, 6, 64));
+
+	const ulong64 bbsP = 11234773052181932039ULL, bbsQ = 15755662711309472467ULL; // the default parameters of BBS
+	check("BBS, Montgomery128 modulo p*q", montgomeryEqualsDoubling((ulong128) bbsP * bbsQ));
+	check("BBS, Montgomery128 modulo 2^128 - 159", montgomeryEqualsDoubling(~(ulong128) 0 - 158));
+	check("BBS, Montgomery128 modulo 3", montgomeryEqualsDoubling(3));
+	check("BBS", bbsEqualsSquarings(bbsP, bbsQ, false));
+	check("BBS -loglog", bbsEqualsSquarings(bbsP, bbsQ, true));
+	check("BBS_2147483647_4294967291 -loglog", bbsEqualsSquarings(2147483647, 4294967291ULL, true));
+	check("BBS_2147483647_4294967291", bbsEqualsSquarings(2147483647, 4294967291ULL, false));
+	check("BBS, jumps", bbsJumpEqualsSequential(bbsP, bbsQ, false, {1, 63, 20000, 30001}));
+	check("BBS -loglog, jumps", bbsJumpEqualsSequential(bbsP, bbsQ, true, {1, 50000}));
+	check("BBS_2147483647_4294967291, jumps", bbsJumpEqualsSequential(2147483647, 4294967291ULL, false, {2, 100000}));
+
+	check("FlawedPath, PackedBits", packedBitsEqualVector());
+	// hashes of the paths of the implementation on vector<bool>
+	const struct { int algorithm; int64 n; int64 seed; ulong64 hash; } paths[] = {
+		{1, 1, 112358, 0xf6b3592e4e0c8873ULL}, {1, 16, 135246, 0x1946a5cb3d3b7243ULL},
+		{1, 1000, 112358, 0x87c43bea59b2b9cbULL}, {1, 4096, 135246, 0xba4a54b6a63cd52dULL},
+		{1, 100003, 112358, 0x07c50ddcda1ebe4dULL}, {1, 100003, 135246, 0x854a070dc1c85a5bULL},
+		{2, 1, 112358, 0xf6aff32e4e09a54aULL}, {2, 16, 135246, 0xfb0c79952f8b5d47ULL},
+		{2, 1000, 112358, 0x3bbdafeac5f7d625ULL}, {2, 4096, 135246, 0x9250ecceaaa60887ULL},
+		{2, 100003, 112358, 0x0d3bc267d11b25c8ULL}, {2, 100003, 135246, 0x48d96cef3b4d29f0ULL},
+	};
+	for (const auto& p : paths) {
+		check("FlawedPath, algorithm " + to_string(p.algorithm) + ", n " + to_string(p.n) + ", seed " + to_string(p.seed),
+		      flawedPathEquals(p.algorithm, p.n, p.seed, p.hash));
+	}
+	check("FlawedPath, algorithm 1, every n <= 300", shortFlawedPathsEqual(1, 0x4c220b73a6bb6f7bULL));
+	check("FlawedPath, algorithm 2, every n <= 300", shortFlawedPathsEqual(2, 0x07970a9acbcc217cULL));
+	check("streaming, n 16", streamEqualsInDistribution(16, 40000));
+	check("streaming, n 64", streamEqualsInDistribution(64, 10000));
+#ifdef __GLIBC__
+	check("C_PRG", cPRGEqualsRand());
+#endif
+
+	return nrOfFailed;
+}
@@ -0,0 +1,562 @@
+#define PRNG_NO_MAIN
+#include "prng.cpp"
+
+#include <sys/wait.h>
+
+/**********************************************************************************
+ *                                                                                *
+ *  testRuns - checks of whole runs of prng.cpp given by their command lines;     *
+ *             every run is made in a child process (a run closes stdout and      *
+ *             exits on errors), its stderr is discarded                          *
+ *                                                                                *
+ *    - parallel: the sequences written to stdout with options changing only how  *
+ *      they are generated (-t, -s) equal those of the serial run                 *
+ *    - pipe: the sequences written to a pipe (with vmsplice, also with small     *
+ *      buffers -buf and a reader slower than the generation, so that the ring of *
+ *      buffers is reused while the pipe may still hold their pages) equal those  *
+ *      written to a file                                                         *
+ *    - analysis: the results of -asin and -lil equal the fractions of time above *
+ *      the line and S_lil at the check points of a walk done bit by bit over     *
+ *      the sequences written to stdout                                           *
+ *    - combined: a run with both -asin and -lil writes the same results and      *
+ *      histograms (-hist, -fhist, named after the tests) as a run of each test   *
+ *    - container: the sequences written with -o and read back with               *
+ *      SeqContainerReader equal those written to stdout                          *
+ *    - shards: histograms (-hist, -fhist) of the shards of a run, merged as by   *
+ *      mergeShards, cover all its seeds and equal those of the run in one piece, *
+ *      also with flawed sequences (zepsuty, FlawedDyckMT) in later shards; those *
+ *      of a run with other options of the PRNG (-f, -loglog) are not merged      *
+ *    - fine histograms: the bins of -fhist are those of the results (-asin,      *
+ *      -lil) written by the run, and for asin up to length 2^16 they give the    *
+ *      histogram of -hist exactly; long names of PRNGs (with options) are kept   *
+ *      whole in their files or rejected                                          *
+ *    - resume: a run interrupted after some results (of -asin, -lil) and         *
+ *      resumed with -resume writes the same files as the run without the         *
+ *      interruption, also with flawed sequences (zepsuty, FlawedDyckMT) after    *
+ *      it; a different run (also of the same PRNG with -stream) is not resumed   *
+ *      from them                                                                 *
+ *    - stop: the sequential test (-stop) does not stop runs of a good PRNG       *
+ *      (Mersenne) at short lengths, where the statistic is far from its          *
+ *      asymptotic law, and stops those of a bad one (RANDU), marking its         *
+ *      histograms (-hist, -fhist) and results (.run) as stopped early            *
+ *                                                                                *
+ *  Prints OK or FAILED for every check, returns the number of failed checks.     *
+ *                                                                                *
+ **********************************************************************************/
+static string dir;
+static int nrOfFailed = 0;
+
+// runs prng with args, its stdout goes to pathToStdout (if given); returns the exit status
+static int runPRNG(const vector<string>& args, const string& pathToStdout = "") {
+	fflush(stdout);
+	pid_t pid = fork();
+	if (pid == 0) {
+		if (!freopen("/dev/null", "w", stderr) || (!pathToStdout.empty() && !freopen(pathToStdout.c_str(), "w", stdout))) {
+			_exit(126);
+		}
+		vector<char*> argv(1, (char*) "prng");
+		for (const string& arg : args) {
+			argv.push_back((char*) arg.c_str());
+		}
+		argv.push_back(NULL);
+		exit(prngMain(argv.size() - 1, argv.data()));
+	}
+	int status = -1;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// runs prng with args, its stdout goes to a pipe read (slowly, pausing after every read) into out; returns the exit status
+static int runPRNGToPipe(const vector<string>& args, vector<char>& out, bool slow) {
+	int fds[2];
+	if (pipe(fds) != 0) {
+		return -1;
+	}
+	fflush(stdout);
+	pid_t pid = fork();
+	if (pid == 0) {
+		close(fds[0]);
+		if (!freopen("/dev/null", "w", stderr) || dup2(fds[1], STDOUT_FILENO) < 0) {
+			_exit(126);
+		}
+		close(fds[1]);
+		vector<char*> argv(1, (char*) "prng");
+		for (const string& arg : args) {
+			argv.push_back((char*) arg.c_str());
+		}
+		argv.push_back(NULL);
+		exit(prngMain(argv.size() - 1, argv.data()));
+	}
+	close(fds[1]);
+	out.clear();
+	char buf[1 << 12];
+	for (ssize_t n; (n = read(fds[0], buf, sizeof(buf))) > 0; ) {
+		out.insert(out.end(), buf, buf + n);
+		if (slow) {
+			this_thread::sleep_for(chrono::microseconds(20));
+		}
+	}
+	close(fds[0]);
+	int status = -1;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static vector<char> readFile(const string& path) {
+	vector<char> data;
+	FILE* f = fopen(path.c_str(), "rb");
+	if (!f) {
+		return data;
+	}
+	char buf[1 << 16];
+	for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0; ) {
+		data.insert(data.end(), buf, buf + n);
+	}
+	fclose(f);
+	return data;
+}
+
+static void writeFile(const string& path, const vector<char>& data) {
+	FILE* f = fopen(path.c_str(), "wb");
+	fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+}
+
+// copies the first nrOfLines lines of the file from and half of the next one, as written by an interrupted run
+static void copyLines(const string& from, const string& to, int nrOfLines) {
+	vector<char> data = readFile(from);
+	size_t end = 0;
+	for (int i = 0; i < nrOfLines && end < data.size(); ++end) {
+		i += data[end] == '\n';
+	}
+	size_t next = end;
+	while (next < data.size() && data[next] != '\n') {
+		++next;
+	}
+	data.resize(end + (next - end) / 2);
+	writeFile(to, data);
+}
+
+static void check(const string& name, bool ok) {
+	printf("%s: %s\n", name.c_str(), ok ? "OK" : "FAILED");
+	nrOfFailed += !ok;
+}
+
+// args (prng, number of sequences, log2 of length, ...) with options; the same run without them writes the same stdout
+static bool stdoutEqualsSerial(const vector<string>& args, const vector<string>& options) {
+	vector<string> withOptions = args;
+	withOptions.insert(withOptions.end(), options.begin(), options.end());
+	if (runPRNG(args, dir + "/serial.bin") != 0 || runPRNG(withOptions, dir + "/options.bin") != 0) {
+		return false;
+	}
+	const vector<char> serial = readFile(dir + "/serial.bin");
+	return !serial.empty() && serial == readFile(dir + "/options.bin");
+}
+
+// args (prng, number of sequences, log2 of length, ...) written to a pipe (read slowly if slow) and to a file
+static bool pipeEqualsFile(const vector<string>& args, bool slow) {
+	vector<char> out;
+	if (runPRNG(args, dir + "/file.bin") != 0 || runPRNGToPipe(args, out, slow) != 0) {
+		return false;
+	}
+	return !out.empty() && out == readFile(dir + "/file.bin");
+}
+
+// values in the lines of a file with results (-asin, -lil), after its header
+static vector<vector<double>> readResults(const string& path) {
+	vector<vector<double>> results;
+	const vector<char> data = readFile(path);
+	string text(data.begin(), data.end());
+	for (size_t end = text.find('\n'); end != string::npos && end + 1 < text.size(); ) {
+		const size_t next = text.find('\n', end + 1);
+		if (next == string::npos) {
+			break;
+		}
+		vector<double> res;
+		const string line = text.substr(end + 1, next - end - 1);
+		const char* p = line.c_str();
+		char* last = NULL;
+		for (double v = strtod(p, &last); last != p; v = strtod(p, &last)) {
+			res.push_back(v);
+			p = last + (*last == ';');
+		}
+		results.push_back(res);
+		end = next;
+	}
+	return results;
+}
+
+// args (prng, number of sequences, log2 of length, ...) with -asin, -lil and -cp nrOfCheckPoints;
+// the same run without them writes the sequences to stdout
+static bool analysisEqualsWalk(const vector<string>& args, int nrOfCheckPoints) {
+	const string pathToStdout = dir + "/stdout.bin";
+	if (runPRNG(args, pathToStdout) != 0) {
+		return false;
+	}
+	vector<vector<double>> results[2];
+	for (TestType type : {TEST_ASIN, TEST_LIL}) {
+		const string path = dir + (type == TEST_ASIN ? "/walk_asin.txt" : "/walk_lil.txt");
+		vector<string> a = args;
+		a.insert(a.end(), {type == TEST_ASIN ? "-asin" : "-lil", path, "-cp", to_string(nrOfCheckPoints)});
+		if (runPRNG(a) != 0) {
+			return false;
+		}
+		results[type] = readResults(path);
+	}
+	// stdout: number of sequences (without the skipped ones) and length, then the words of the sequences
+	const vector<char> out = readFile(pathToStdout);
+	const int logLength = stoi(args[2]);
+	const size_t seqWords = (1LL << logLength) / 64;
+	const long64 nrOfStrings = out.size() >= 2 * sizeof(long64) ? *(const long64*) out.data() : -1;
+	if (nrOfStrings < 0 || out.size() != 2 * sizeof(long64) + nrOfStrings * seqWords * 8
+	    || results[TEST_ASIN].size() != (size_t) nrOfStrings || results[TEST_LIL].size() != (size_t) nrOfStrings) {
+		return false;
+	}
+	const ulong64* words = (const ulong64*) (out.data() + 2 * sizeof(long64));
+	for (long64 s = 0; s < nrOfStrings; ++s) {
+		// bits of a word from the least significant one, a step is above the line if the walk is above it before or after it
+		long64 balance = 0, above = 0, pos = 0;
+		int cp = 0;
+		for (size_t w = 0; w < seqWords; ++w) {
+			for (int b = 0; b < 64; ++b) {
+				const long64 prevBalance = balance;
+				balance += ((words[s * seqWords + w] >> b) & 1) ? 1 : -1;
+				above += prevBalance > 0 || balance > 0;
+				if (++pos != 1LL << (logLength - nrOfCheckPoints + cp)) {
+					continue;
+				}
+				const double n = pos;
+				const double frac = (double) above / pos;
+				const double slil = balance / sqrt(n) / sqrt(2 * log(log(n)));
+				if (results[TEST_ASIN][s].size() != (size_t) nrOfCheckPoints + 1 || results[TEST_LIL][s].size() != (size_t) nrOfCheckPoints + 1
+				    || results[TEST_ASIN][s][cp] != frac || fabs(results[TEST_LIL][s][cp] - slil) > 1e-12) {
+					return false;
+				}
+				++cp;
+			}
+		}
+	}
+	return true;
+}
+
+// args (prng, number of sequences, log2 of length, ...) with -asin and -lil (and -cp 4, -hist, -fhist) at once and apart
+static bool combinedEqualsSeparate(const vector<string>& args) {
+	auto runTests = [&](const vector<TestType>& types, const string& name) {
+		vector<string> a = args;
+		for (TestType type : types) {
+			const string test = type == TEST_ASIN ? "asin" : "lil";
+			a.insert(a.end(), {"-" + test, dir + "/" + name + "_" + test + ".txt"});
+		}
+		// with both tests the histograms get the names of the tests
+		const string hist = dir + "/" + name + (types.size() > 1 ? "" : types[0] == TEST_ASIN ? "_asin" : "_lil");
+		a.insert(a.end(), {"-cp", "4", "-hist", hist + ".hist", "-fhist", hist + ".fhist"});
+		return runPRNG(a) == 0;
+	};
+	if (!runTests({TEST_ASIN, TEST_LIL}, "both") || !runTests({TEST_ASIN}, "apart") || !runTests({TEST_LIL}, "apart")) {
+		return false;
+	}
+	for (const char* file : {"_asin.txt", "_lil.txt", "_asin.hist", "_lil.hist", "_asin.fhist", "_lil.fhist"}) {
+		const vector<char> both = readFile(dir + "/both" + file);
+		if (both.empty() || both != readFile(dir + "/apart" + file)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// args (prng, number of sequences, log2 of length, ...) with -o; the same run without -o writes to stdout
+static bool containerEqualsStdout(const vector<string>& args, const vector<string>& options) {
+	const string pathToStdout = dir + "/stdout.bin";
+	const string pathToContainer = dir + "/container.seq";
+	vector<string> withContainer = args;
+	withContainer.insert(withContainer.end(), options.begin(), options.end());
+	withContainer.push_back("-o");
+	withContainer.push_back(pathToContainer);
+	if (runPRNG(args, pathToStdout) != 0 || runPRNG(withContainer) != 0) {
+		return false;
+	}
+	// stdout: number of sequences and length, then the words of the sequences
+	const vector<char> out = readFile(pathToStdout);
+	SeqContainerReader reader(pathToContainer.c_str());
+	const SeqContainerHeader& header = reader.getHeader();
+	const size_t seqBytes = header.length / 8;
+	if (out.size() != 2 * sizeof(long64) + header.nrOfStrings * seqBytes || header.nrOfStrings != *(const long64*) out.data()) {
+		return false;
+	}
+	for (int64 i = 0; i < header.nrOfStrings; ++i) {
+		if (memcmp(reader.getSequence(i), out.data() + 2 * sizeof(long64) + i * seqBytes, seqBytes) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// what print writes to a file
+static string printed(function<void(FILE*)> print) {
+	const string path = dir + "/printed.txt";
+	FILE* f = fopen(path.c_str(), "w");
+	print(f);
+	fclose(f);
+	const vector<char> text = readFile(path);
+	return string(text.begin(), text.end());
+}
+
+// args (prng, number of sequences, log2 of length, ...) with -asin, -cp, -hist, -fhist and -shard k/nrOfShards
+static bool shardsEqualSingleRun(const vector<string>& args, int nrOfShards) {
+	// the files of shard k/n are dir/k_n.*
+	auto runShard = [&](int k, int n) {
+		const string name = dir + "/" + to_string(k) + "_" + to_string(n);
+		vector<string> a = args;
+		a.insert(a.end(), {"-asin", name + ".txt", "-cp", "4", "-hist", name + ".hist", "-fhist", name + ".fhist",
+		                   "-shard", to_string(k) + "/" + to_string(n)});
+		return runPRNG(a) == 0;
+	};
+	for (int k = 1; k <= nrOfShards; ++k) {
+		if (!runShard(k, nrOfShards)) {
+			return false;
+		}
+	}
+	if (!runShard(1, 1)) {
+		return false;
+	}
+	ResultHistogram single((dir + "/1_1.hist").c_str());
+	FineHistogram singleFine((dir + "/1_1.fhist").c_str());
+	const string first = dir + "/1_" + to_string(nrOfShards);
+	ResultHistogram merged((first + ".hist").c_str());
+	FineHistogram mergedFine((first + ".fhist").c_str());
+	for (int k = 2; k <= nrOfShards; ++k) {
+		const string shard = dir + "/" + to_string(k) + "_" + to_string(nrOfShards);
+		merged.add(ResultHistogram((shard + ".hist").c_str()));
+		mergedFine.add(FineHistogram((shard + ".fhist").c_str()));
+	}
+	return single.getNrOfMissingSeeds() == 0 && merged.getNrOfMissingSeeds() == 0 && mergedFine.getNrOfMissingSeeds() == 0
+	    && merged.getNrOfSeqs() == single.getNrOfSeqs()
+	    && printed([&](FILE* f) { merged.printTable(f); }) == printed([&](FILE* f) { single.printTable(f); })
+	    && printed([&](FILE* f) { mergedFine.printRebinned(f, 64); }) == printed([&](FILE* f) { singleFine.printRebinned(f, 64); });
+}
+
+// true if f returns in a child process; histograms exit on errors, e.g. when histograms of different runs are added
+static bool returnsInChild(function<void()> f) {
+	fflush(stdout);
+	pid_t pid = fork();
+	if (pid == 0) {
+		if (!freopen("/dev/null", "w", stderr)) {
+			_exit(126);
+		}
+		f();
+		_exit(0);
+	}
+	int status = -1;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// true if the histograms (of the same class) in files path and otherPath are merged
+template <class Histogram>
+static bool mergedInChild(const string& path, const string& otherPath) {
+	return returnsInChild([&]() { Histogram(path.c_str()).add(Histogram(otherPath.c_str())); });
+}
+
+// the histograms (-hist, -fhist) of shard 1/2 of the run of args are merged with those of shard 2/2
+// of the same run but not with those of shard 2/2 of the run of otherArgs (other options of the PRNG)
+static bool shardsOfOtherRunNotMerged(const vector<string>& args, const vector<string>& otherArgs) {
+	auto runShard = [&](const vector<string>& args, const string& name, const char* shard) {
+		vector<string> a = args;
+		a.insert(a.end(), {"-asin", dir + "/" + name + ".txt", "-hist", dir + "/" + name + ".hist",
+		                   "-fhist", dir + "/" + name + ".fhist", "-shard", shard});
+		return runPRNG(a) == 0;
+	};
+	if (!runShard(args, "first", "1/2") || !runShard(args, "second", "2/2") || !runShard(otherArgs, "other", "2/2")) {
+		return false;
+	}
+	const string first = dir + "/first", second = dir + "/second", other = dir + "/other";
+	return mergedInChild<ResultHistogram>(first + ".hist", second + ".hist")
+	    && mergedInChild<FineHistogram>(first + ".fhist", second + ".fhist")
+	    && !mergedInChild<ResultHistogram>(first + ".hist", other + ".hist")
+	    && !mergedInChild<FineHistogram>(first + ".fhist", other + ".fhist");
+}
+
+// fine histograms of PRNGs whose names (with options) differ only after 63 characters are not merged,
+// and names longer than the header holds are rejected instead of being cut
+static bool longNamesNotCut() {
+	const string name = "BBS_18446744073709551359_18446744073709551427 -f 1234567 -loglog";
+	SeqAnalyzer analyzer(2, 10);
+	auto writeFine = [&](const string& prngName, const string& path, int64 first) {
+		FineHistogram fine(TEST_ASIN, analyzer, 10, prngName);
+		fine.setSeeds("", first, 10, 20);
+		fine.write((dir + "/" + path).c_str());
+	};
+	writeFine(name, "long.fhist", 0);
+	writeFine(name, "same.fhist", 10);
+	writeFine(name + " -stream", "longer.fhist", 10);
+	return mergedInChild<FineHistogram>(dir + "/long.fhist", dir + "/same.fhist")
+	    && !mergedInChild<FineHistogram>(dir + "/long.fhist", dir + "/longer.fhist")
+	    && !returnsInChild([&]() { FineHistogram(TEST_ASIN, analyzer, 10, string(128, 'x')); })
+	    && !returnsInChild([&]() { FineHistogram(TEST_ASIN, analyzer, 10, name).setSeeds(string(256, 'x'), 0, 10, 20); });
+}
+
+// args (prng, number of sequences, log2 of length, ...) with -asin or -lil, -cp nrOfCheckPoints, -hist and -fhist
+static bool fineEqualsResults(const vector<string>& args, TestType type, int nrOfCheckPoints) {
+	vector<string> a = args;
+	a.insert(a.end(), {type == TEST_ASIN ? "-asin" : "-lil", dir + "/fine.txt", "-cp", to_string(nrOfCheckPoints),
+	                   "-hist", dir + "/fine.hist", "-fhist", dir + "/fine.fhist"});
+	if (runPRNG(a) != 0) {
+		return false;
+	}
+	const FineHistogram fine((dir + "/fine.fhist").c_str());
+	SeqAnalyzer analyzer(nrOfCheckPoints, stoi(args[2]));
+	FineHistogram fromResults(type, analyzer, stoi(args[2]), args[0]);
+	const vector<vector<double>> results = readResults(dir + "/fine.txt");
+	for (const vector<double>& res : results) {
+		fromResults.addResult(res);
+	}
+	if (results.empty() || fine.getNrOfSeqs() != (int64) results.size()) {
+		return false;
+	}
+	for (int cp = 0; cp <= nrOfCheckPoints; ++cp) {
+		if (fine.rebin(cp, FineHistogram::nrOfBins) != fromResults.rebin(cp, FineHistogram::nrOfBins)) {
+			return false;
+		}
+	}
+	const ResultHistogram histogram((dir + "/fine.hist").c_str());
+	return type != TEST_ASIN || stoi(args[2]) > 16
+	    || printed([&](FILE* f) { ResultHistogram(fine).printTable(f); }) == printed([&](FILE* f) { histogram.printTable(f); });
+}
+
+// args (prng, number of sequences, log2 of length, ...) with -asin, -lil, -cp and -hist; the run is
+// interrupted after asinLines, lilLines lines (with the header) of the results, which are not resumed
+// by a run with otherOptions (changing the output of the PRNG) either
+static bool resumeEqualsUninterrupted(const vector<string>& args, int asinLines, int lilLines,
+                                      const vector<string>& otherOptions = {}) {
+	auto runTests = [&](const vector<string>& args, const string& name, bool resume) {
+		vector<string> a = args;
+		a.insert(a.end(), {"-asin", dir + "/" + name + "_asin.txt", "-lil", dir + "/" + name + "_lil.txt", "-cp", "4",
+		                   "-hist", dir + "/" + name + ".hist"});
+		if (resume) {
+			a.push_back("-resume");
+		}
+		return runPRNG(a);
+	};
+	if (runTests(args, "full", false) != 0) {
+		return false;
+	}
+	copyLines(dir + "/full_asin.txt", dir + "/part_asin.txt", asinLines);
+	copyLines(dir + "/full_lil.txt", dir + "/part_lil.txt", lilLines);
+	for (const char* test : {"asin", "lil"}) {
+		const string ext = string("_") + test + ".txt.run";
+		writeFile(dir + "/part" + ext, readFile(dir + "/full" + ext));
+	}
+	// another PRNG or another range of seeds
+	vector<string> otherPRNG = args;
+	otherPRNG[0] = otherPRNG[0] == "Minstd" ? "Mersenne" : "Minstd";
+	vector<string> otherSeeds = args;
+	otherSeeds.insert(otherSeeds.begin() + 3, "1");
+	vector<string> otherOutputs = args;
+	otherOutputs.insert(otherOutputs.end(), otherOptions.begin(), otherOptions.end());
+	if (runTests(otherPRNG, "part", true) == 0 || runTests(otherSeeds, "part", true) == 0
+	    || (!otherOptions.empty() && runTests(otherOutputs, "part", true) == 0)) {
+		return false;
+	}
+	if (runTests(args, "part", true) != 0) {
+		return false;
+	}
+	for (const char* file : {"_asin.txt", "_lil.txt", "_asin.hist", "_lil.hist"}) {
+		if (readFile(dir + "/full" + file) != readFile(dir + "/part" + file)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// args (prng, number of sequences, log2 of length, ...) with -asin, -lil and -stop 0.01; 1 if the run was stopped
+// and all its outputs are marked so, 0 if it was not and none of them is, -1 otherwise
+static int isStopped(const vector<string>& args) {
+	vector<string> a = args;
+	a.insert(a.end(), {"-asin", dir + "/asin.txt", "-lil", dir + "/lil.txt", "-hist", dir + "/stop.hist",
+	                   "-fhist", dir + "/stop.fhist", "-stop", "0.01"});
+	if (runPRNG(a) != 0) {
+		return -1;
+	}
+	int nrOfMarked = 0;
+	bool complete = true;
+	for (const char* test : {"asin", "lil"}) {
+		const string name = dir + "/stop_" + test;
+		const ResultHistogram histogram((name + ".hist").c_str());
+		const FineHistogram fine((name + ".fhist").c_str());
+		const vector<char> run = readFile(dir + "/" + test + ".txt.run");
+		const string marker = "earlystopped\n";
+		nrOfMarked += histogram.isEarlyStopped() + fine.isEarlyStopped() + ResultHistogram(fine).isEarlyStopped()
+		              + (run.size() >= marker.size() && equal(marker.begin(), marker.end(), run.end() - marker.size()));
+		complete = complete && histogram.getNrOfSeqs() == stoll(args[1]) && fine.getNrOfSeqs() == stoll(args[1]);
+	}
+	return nrOfMarked == 0 && complete ? 0 : (nrOfMarked == 8 && !complete ? 1 : -1);
+}
+
+int main() {
+	char tmp[] = "/tmp/testRunsXXXXXX";
+	if (!mkdtemp(tmp)) {
+		perror("testRuns");
+		return 1;
+	}
+	dir = tmp;
+
+	check("parallel Mersenne -t 3", stdoutEqualsSerial({"Mersenne", "20", "12"}, {"-t", "3"}));
+	check("parallel Minstd (lanes) -t 4, skip 5", stdoutEqualsSerial({"Minstd", "37", "10", "5"}, {"-t", "4"}));
+	check("parallel FlawedDyckMT -t 2", stdoutEqualsSerial({"FlawedDyckMT", "30", "10", "-f", "7"}, {"-t", "2"}));
+	check("parallel Mersenne -t 3, more threads than sequences", stdoutEqualsSerial({"Mersenne", "2", "10"}, {"-t", "3"}));
+	check("parallel Minstd -s 8", stdoutEqualsSerial({"Minstd", "5", "12"}, {"-s", "8"}));
+	check("parallel Minstd0 -s 4 -t 3, skip 2", stdoutEqualsSerial({"Minstd0", "9", "12", "2"}, {"-s", "4", "-t", "3"}));
+	check("parallel BBS -s 8 -t 2", stdoutEqualsSerial({"BBS", "3", "14"}, {"-s", "8", "-t", "2"}));
+	check("parallel FlawedDyckMT -s 2 -t 2", stdoutEqualsSerial({"FlawedDyckMT", "20", "10", "-f", "7"}, {"-s", "2", "-t", "2"}));
+
+	check("pipe Mersenne", pipeEqualsFile({"Mersenne", "8", "22"}, false));
+	check("pipe Minstd0 (lanes) -t 3 -buf 16", pipeEqualsFile({"Minstd0", "40", "18", "-t", "3", "-buf", "16"}, false));
+	check("pipe RANDU -nolen -buf 1, a part of a page", pipeEqualsFile({"RANDU", "3", "6", "-nolen", "-buf", "1"}, false));
+	check("pipe Mersenne -buf 64, slow reader", pipeEqualsFile({"Mersenne", "8", "20", "-buf", "64"}, true));
+	check("pipe Minstd0 (lanes) -t 3 -buf 16, slow reader", pipeEqualsFile({"Minstd0", "40", "18", "-t", "3", "-buf", "16"}, true));
+
+	check("analysis Mersenne", analysisEqualsWalk({"Mersenne", "20", "12"}, 5));
+	check("analysis Minstd (lanes), skip 3", analysisEqualsWalk({"Minstd", "21", "10", "3"}, 4));
+	check("analysis RANDU, one check point", analysisEqualsWalk({"RANDU", "10", "8"}, 0));
+	check("analysis Mersenne -t 3", analysisEqualsWalk({"Mersenne", "20", "12", "-t", "3"}, 5));
+	check("analysis Minstd -s 4 -t 2", analysisEqualsWalk({"Minstd", "9", "12", "-s", "4", "-t", "2"}, 2));
+
+	check("combined Mersenne", combinedEqualsSeparate({"Mersenne", "30", "12"}));
+	check("combined Minstd (lanes) -t 3, skip 4", combinedEqualsSeparate({"Minstd", "41", "10", "4", "-t", "3"}));
+	check("combined BBS -s 4", combinedEqualsSeparate({"BBS", "5", "12", "-s", "4"}));
+
+	check("container Mersenne", containerEqualsStdout({"Mersenne", "20", "12"}, {}));
+	check("container Mersenne -t 3", containerEqualsStdout({"Mersenne", "20", "12"}, {"-t", "3"}));
+	check("container Mersenne -s 4 -t 2", containerEqualsStdout({"Mersenne", "20", "12"}, {"-s", "4", "-t", "2"}));
+	check("container Minstd (lanes)", containerEqualsStdout({"Minstd", "21", "10"}, {}));
+	check("container Minstd (lanes) -t 2, skip 3", containerEqualsStdout({"Minstd", "21", "10", "3"}, {"-t", "2"}));
+
+	check("shards Minstd, skip 5", shardsEqualSingleRun({"Minstd", "30", "10", "5"}, 3));
+	check("shards Mersenne -t 2, skip 7", shardsEqualSingleRun({"Mersenne", "40", "12", "7", "-t", "2"}, 4));
+	check("shards zepsuty, flawed sequences in the last shards", shardsEqualSingleRun({"zepsuty", "250", "8"}, 3));
+	check("shards FlawedDyckMT -f 7 -t 2, skip 3", shardsEqualSingleRun({"FlawedDyckMT", "30", "10", "3", "-f", "7", "-t", "2"}, 4));
+	check("shards of FlawedDyckMT -f 7 and -f 8 not merged",
+	      shardsOfOtherRunNotMerged({"FlawedDyckMT", "30", "10", "-f", "7"}, {"FlawedDyckMT", "30", "10", "-f", "8"}));
+	check("shards of BBS and BBS -loglog not merged", shardsOfOtherRunNotMerged({"BBS", "6", "10"}, {"BBS", "6", "10", "-loglog"}));
+
+	check("fine histograms Mersenne, asin", fineEqualsResults({"Mersenne", "300", "12", "-t", "2"}, TEST_ASIN, 6));
+	check("fine histograms RANDU, asin, length 2^16", fineEqualsResults({"RANDU", "50", "16"}, TEST_ASIN, 3));
+	check("fine histograms Minstd (lanes), lil", fineEqualsResults({"Minstd", "300", "12"}, TEST_LIL, 6));
+	check("fine histograms of long names of PRNGs", longNamesNotCut());
+
+	check("resume Mersenne", resumeEqualsUninterrupted({"Mersenne", "30", "10"}, 12, 12));
+	check("resume Minstd (lanes) -t 2, asin and lil interrupted apart", resumeEqualsUninterrupted({"Minstd", "30", "10", "-t", "2"}, 20, 7));
+	check("resume Mersenne, interrupted in the first result", resumeEqualsUninterrupted({"Mersenne", "30", "10"}, 1, 1));
+	check("resume zepsuty, flawed sequences after the interruption", resumeEqualsUninterrupted({"zepsuty", "250", "8"}, 38, 90));
+	check("resume FlawedDyckMT -f 10 -t 2", resumeEqualsUninterrupted({"FlawedDyckMT", "30", "10", "-f", "10", "-t", "2"}, 14, 6));
+	check("resume FlawedDyck, not with -stream", resumeEqualsUninterrupted({"FlawedDyck", "6", "10"}, 3, 4, {"-stream"}));
+	check("resume FlawedDyck -stream", resumeEqualsUninterrupted({"FlawedDyck", "6", "10", "-stream"}, 4, 3));
+
+	check("stop Mersenne, length 2^6", isStopped({"Mersenne", "20000", "6", "-t", "4"}) == 0);
+	check("stop Mersenne, length 2^10, 4 check points", isStopped({"Mersenne", "20000", "10", "-cp", "4", "-t", "4"}) == 0);
+	check("stop Mersenne, length 2^12, 6 check points", isStopped({"Mersenne", "20000", "12", "-cp", "6", "-t", "4"}) == 0);
+	check("stop RANDU, length 2^10", isStopped({"RANDU", "20000", "10", "-cp", "4"}) == 1);
+
+	system(("rm -rf " + dir).c_str());
+	return nrOfFailed;
+}